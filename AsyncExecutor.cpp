@@ -0,0 +1,119 @@
+/* 
+ * File:   AsyncExecutor.cpp
+ * Created on 17 ottobre 2026
+ */
+
+#include <cstdio> // fprintf
+#include <utility> // std::move
+#include "AsyncExecutor.h"
+
+AsyncExecutor::AsyncExecutor(size_t threads, size_t maxPending) : maxPending(maxPending ? maxPending : 1) {
+    if (threads == 0)
+        threads = 1;
+
+    for (size_t i = 0; i < threads; ++i)
+        workers.emplace_back(&AsyncExecutor::run, this);
+}
+
+AsyncExecutor::~AsyncExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    notEmpty.notify_all();
+    // a task posting to a full queue would keep its worker from being joined
+    notFull.notify_all();
+
+    for (auto &worker : workers)
+        worker.join();
+}
+
+void AsyncExecutor::post(const void* key, std::function<void()> task) {
+    std::unique_lock<std::mutex> lock(mutex);
+    notFull.wait(lock, [this] {
+        return stopping || pending < maxPending;
+    });
+
+    if (stopping)
+        throw std::logic_error("AsyncExecutor: stopping!");
+
+    ++pending;
+
+    if (key) {
+        Strand& strand = strands[key];
+        strand.tasks.push_back(std::move(task));
+        if (strand.running)
+            return;
+
+        strand.running = true;
+        queue.push_back([this, key] {
+            runStrand(key);
+        });
+    } else
+        queue.push_back(std::move(task));
+
+    lock.unlock();
+    notEmpty.notify_one();
+}
+
+void AsyncExecutor::runStrand(const void* key) {
+    std::function<void()> task;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Strand& strand = strands[key];
+        task = std::move(strand.tasks.front());
+        strand.tasks.pop_front();
+    }
+
+    runTask(task);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    Strand& strand = strands[key];
+    if (strand.tasks.empty()) {
+        strands.erase(key);
+        return;
+    }
+
+    // next task of the same key goes back in the queue, behind the other keys
+    queue.push_back([this, key] {
+        runStrand(key);
+    });
+    lock.unlock();
+    notEmpty.notify_one();
+}
+
+void AsyncExecutor::run() {
+    for (;;) {
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            notEmpty.wait(lock, [this] {
+                return stopping || !queue.empty();
+            });
+
+            if (queue.empty())
+                return;
+
+            task = std::move(queue.front());
+            queue.pop_front();
+            // a strand entry stands for the strand task it is going to run
+            --pending;
+        }
+        notFull.notify_one();
+
+        runTask(task);
+    }
+}
+
+void AsyncExecutor::runTask(std::function<void()>& task) {
+    // submit() hands exceptions to the future, only plain posted tasks get here
+    try {
+        task();
+    } catch (const std::exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+    } catch (...) {
+        fprintf(stderr, "AsyncExecutor: unknown exception\n");
+    }
+}
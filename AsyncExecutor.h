@@ -0,0 +1,138 @@
+/* 
+ * File:   AsyncExecutor.h
+ * Created on 17 ottobre 2026
+ */
+
+#ifndef ASYNCEXECUTOR_H
+#define ASYNCEXECUTOR_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+#include <coroutine>
+#define FB_WRAPPER_COROUTINES 1
+#endif
+
+// Bounded thread pool for blocking database calls.
+// Tasks posted with the same key (the Attachment they run on) are executed
+// one at a time and in order, so each attachment is used by one worker at a
+// time while many attachments are multiplexed over a few threads. The
+// attachments stay owned by the caller or an AttachmentPool.
+// post() blocks when maxPending tasks are already waiting, and throws
+// std::logic_error once the executor is being destroyed.
+// The awaitables need C++20; the library itself builds as C++17.
+class AsyncExecutor {
+public:
+    explicit AsyncExecutor(size_t threads = std::thread::hardware_concurrency(), size_t maxPending = 1024);
+    AsyncExecutor(const AsyncExecutor&) = delete;
+    AsyncExecutor& operator=(const AsyncExecutor&) = delete;
+    // waits for the queued tasks
+    virtual ~AsyncExecutor();
+
+    void post(const void* key, std::function<void()> task);
+
+    template <typename F>
+    auto submit(const void* key, F&& fn) -> std::future<decltype(fn())>;
+
+#ifdef FB_WRAPPER_COROUTINES
+    // co_await resumes the coroutine on the worker that ran fn
+    template <typename T>
+    class Awaitable {
+    public:
+        Awaitable(AsyncExecutor* executor, const void* key, std::function<T()> fn)
+        : executor(executor), key(key), fn(std::move(fn)) {
+        }
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            executor->post(key, [this, handle] {
+                try {
+                    if constexpr (std::is_void<T>::value)
+                        fn();
+                    else
+                        result.emplace(fn());
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                handle.resume();
+            });
+        }
+
+        T await_resume() {
+            if (error)
+                std::rethrow_exception(error);
+            if constexpr (!std::is_void<T>::value)
+                return std::move(*result);
+        }
+    private:
+        struct Empty {
+        };
+
+        AsyncExecutor* executor;
+        const void* key;
+        std::function<T()> fn;
+        std::optional<std::conditional_t<std::is_void<T>::value, Empty, T> > result;
+        std::exception_ptr error;
+    };
+
+    template <typename F>
+    auto schedule(const void* key, F&& fn) -> Awaitable<decltype(fn())>;
+#endif
+private:
+    struct Strand {
+        std::deque<std::function<void()> > tasks;
+        bool running = false;
+    };
+
+    void run();
+    void runStrand(const void* key);
+    static void runTask(std::function<void()>& task);
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()> > queue;
+    std::unordered_map<const void*, Strand> strands;
+    size_t maxPending;
+    size_t pending = 0; // posted and not started yet
+
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    bool stopping = false;
+};
+
+template <typename F>
+auto AsyncExecutor::submit(const void* key, F&& fn) -> std::future<decltype(fn())> {
+    typedef decltype(fn()) T;
+
+    auto task = std::make_shared<std::packaged_task<T()> >(std::forward<F>(fn));
+    std::future<T> ret = task->get_future();
+    post(key, [task] {
+        (*task)();
+    });
+    return ret;
+}
+
+#ifdef FB_WRAPPER_COROUTINES
+
+template <typename F>
+auto AsyncExecutor::schedule(const void* key, F&& fn) -> Awaitable<decltype(fn())> {
+    return Awaitable<decltype(fn())>(this, key, std::forward<F>(fn));
+}
+#endif
+
+#endif /* ASYNCEXECUTOR_H */
+
@@ -15,7 +15,13 @@ void formatExceptionMessage(const FbException& error, char *msg, unsigned int le
     util->formatStatus(msg, len, error.getStatus());
 }
 
+void formatStatusMessage(const IStatus* st, char *msg, unsigned int len) {
+    util->formatStatus(msg, len, st);
+}
+
 Attachment::Attachment() {
+    // the dispatcher is shared by all attachments: each one holds a reference
+    provider->addRef();
     status = new ThrowStatusWrapper(master->getStatus());
 }
 
@@ -35,7 +41,11 @@ void Attachment::setParameter(std::string server, std::string database, std::str
     this->username = std::move(username);
     this->password = std::move(password);
     this->charset = std::move(charset);
-    connectionString = this->server + ":" + this->database;
+    // no server: local database, opened by the embedded engine when available
+    if (this->server.empty())
+        connectionString = this->database;
+    else
+        connectionString = this->server + ":" + this->database;
 
     if (dpb)
         dpb->dispose();
@@ -49,6 +59,7 @@ void Attachment::setParameter(std::string server, std::string database, std::str
 
 Attachment::~Attachment() {
     dispatcher.broadcast(DBStateEvents::ATTACHMENT_DELETE);
+    statementCache.clear();
 
     if (att_) {
         att_->release();
@@ -77,8 +88,10 @@ void Attachment::disconnect() {
     if (att_) {
         try {
             dispatcher.broadcast(DBStateEvents::ATTACHMENT_DISCONNECT);
+            statementCache.clear();
             att_->detach(status);
         } catch (const FbException& e) {
+            statementCache.clear();
             att_->release();
             
             char buf[256];
@@ -90,6 +103,35 @@ void Attachment::disconnect() {
     }
 }
 
+bool Attachment::isConnected() {
+    return att_ != nullptr;
+}
+
+void Attachment::ping() {
+    if (!att_)
+        throw std::logic_error("Attachment: connect before ping!");
+
+    att_->ping(status);
+}
+
+void Attachment::dropDatabase() {
+    if (!att_)
+        throw std::logic_error("Drop database: connect before");
+
+    dispatcher.broadcast(DBStateEvents::ATTACHMENT_DISCONNECT);
+    statementCache.clear();
+    att_->dropDatabase(status);
+    att_ = nullptr;
+}
+
 IAttachment* Attachment::getHandle() {
     return att_;
-}
\ No newline at end of file
+}
+
+void Attachment::setStatementCacheSize(size_t size) {
+    statementCache.setCapacity(size);
+}
+
+StatementCache::Stats Attachment::getStatementCacheStats() const {
+    return statementCache.getStats();
+}
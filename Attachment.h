@@ -9,6 +9,7 @@
 
 #include <vector>
 #include "EventDispatcher.h"
+#include "StatementCache.h"
 #include "fb-wrapper.h"
 
 class Transaction;
@@ -17,6 +18,8 @@ class Statement;
 class Attachment {
     friend class Transaction;
     friend class Statement;
+    friend class Blob;
+    friend class EventSubscription;
 public:
     Attachment();
     void setParameter(std::string server, std::string database, std::string username, std::string password, std::string charset);
@@ -24,13 +27,19 @@ public:
     virtual ~Attachment();
     void connect();
     void disconnect();
+    void dropDatabase();
+    bool isConnected();
+    void ping();
     void startTransaction();
     IAttachment* getHandle();
+    void setStatementCacheSize(size_t size);
+    StatementCache::Stats getStatementCacheStats() const;
     EventDispatcher<DBStateEvents> dispatcher; 
 private:
     IAttachment* att_ = nullptr;
     ThrowStatusWrapper* status = nullptr;
     IXpbBuilder* dpb = nullptr;
+    StatementCache statementCache;
 
     std::string server;
     std::string database;
@@ -42,6 +51,7 @@ private:
 };
 
 extern void formatExceptionMessage(const FbException& error, char *msg, unsigned int len);
+extern void formatStatusMessage(const IStatus* st, char *msg, unsigned int len);
 
 #endif /* ATTACHMENT_H */
 
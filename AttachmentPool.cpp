@@ -0,0 +1,261 @@
+/* 
+ * File:   AttachmentPool.cpp
+ * Created on 17 ottobre 2026
+ */
+
+#include <utility> // std::move
+#include "AttachmentPool.h"
+
+/*********************************************************
+ * Lease
+ */
+AttachmentPool::Lease::Lease(AttachmentPool* pool, std::unique_ptr<Attachment> attachment)
+: pool(pool), attachment(std::move(attachment)) {
+}
+
+AttachmentPool::Lease::Lease(Lease&& other)
+: pool(other.pool), attachment(std::move(other.attachment)), broken(other.broken) {
+    other.pool = nullptr;
+}
+
+AttachmentPool::Lease& AttachmentPool::Lease::operator=(Lease&& other) {
+    if (this != &other) {
+        release();
+        pool = other.pool;
+        attachment = std::move(other.attachment);
+        broken = other.broken;
+        other.pool = nullptr;
+    }
+    return *this;
+}
+
+AttachmentPool::Lease::~Lease() {
+    release();
+}
+
+AttachmentPool::Lease::operator bool() const {
+    return attachment != nullptr;
+}
+
+Attachment* AttachmentPool::Lease::get() const {
+    return attachment.get();
+}
+
+Attachment* AttachmentPool::Lease::operator->() const {
+    return attachment.get();
+}
+
+Attachment& AttachmentPool::Lease::operator*() const {
+    return *attachment;
+}
+
+void AttachmentPool::Lease::invalidate() {
+    broken = true;
+}
+
+void AttachmentPool::Lease::release() {
+    if (pool && attachment)
+        pool->giveBack(std::move(attachment), broken);
+
+    pool = nullptr;
+    broken = false;
+}
+
+/*********************************************************
+ * AttachmentPool
+ */
+AttachmentPool::AttachmentPool(std::string server, std::string database, std::string username,
+        std::string password, std::string charset)
+: AttachmentPool(std::move(server), std::move(database), std::move(username),
+std::move(password), std::move(charset), Options()) {
+}
+
+AttachmentPool::AttachmentPool(std::string server, std::string database, std::string username,
+        std::string password, std::string charset, Options options)
+: server(std::move(server)), database(std::move(database)), username(std::move(username)),
+password(std::move(password)), charset(std::move(charset)), options(options) {
+    if (options.maxSize == 0 || options.minSize > options.maxSize)
+        throw std::invalid_argument("AttachmentPool: invalid size!");
+
+    Clock::time_point now = Clock::now();
+    for (size_t i = 0; i < options.minSize; ++i) {
+        idle.push_back({create(), now});
+        ++total;
+    }
+}
+
+AttachmentPool::~AttachmentPool() {
+    for (auto &slot : idle)
+        destroy(std::move(slot.attachment));
+}
+
+AttachmentPool::Lease AttachmentPool::acquire() {
+    return acquire(nullptr);
+}
+
+AttachmentPool::Lease AttachmentPool::acquire(std::chrono::milliseconds timeout) {
+    Clock::time_point deadline = Clock::now() + timeout;
+    return acquire(&deadline);
+}
+
+AttachmentPool::Lease AttachmentPool::acquire(const Clock::time_point* deadline) {
+    Clock::time_point start = Clock::now();
+    bool waited = false;
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for (;;) {
+        if (!idle.empty()) {
+            Slot slot = std::move(idle.back());
+            idle.pop_back();
+            ++metrics.active;
+            lock.unlock();
+
+            // health check outside the lock
+            bool valid = true;
+            if (Clock::now() - slot.lastUsed >= options.validationInterval) {
+                try {
+                    slot.attachment->ping();
+                } catch (const FbException&) {
+                    valid = false;
+                }
+            }
+
+            lock.lock();
+            if (valid) {
+                recordCheckout(start, waited);
+                return Lease(this, std::move(slot.attachment));
+            }
+
+            ++metrics.validationFailures;
+            --metrics.active;
+            --total;
+            lock.unlock();
+            destroy(std::move(slot.attachment));
+            lock.lock();
+            continue;
+        }
+
+        if (total < options.maxSize) {
+            ++total;
+            ++metrics.active;
+            lock.unlock();
+
+            std::unique_ptr<Attachment> attachment;
+            try {
+                attachment = create();
+            } catch (...) {
+                lock.lock();
+                --total;
+                --metrics.active;
+                available.notify_one();
+                throw;
+            }
+
+            lock.lock();
+            recordCheckout(start, waited);
+            return Lease(this, std::move(attachment));
+        }
+
+        waited = true;
+        if (deadline) {
+            if (available.wait_until(lock, *deadline) == std::cv_status::timeout
+                    && idle.empty() && total >= options.maxSize) {
+                ++metrics.timeouts;
+                return Lease();
+            }
+        } else
+            available.wait(lock);
+    }
+}
+
+void AttachmentPool::recordCheckout(Clock::time_point start, bool waited) {
+    //!! call with mutex locked
+    std::chrono::nanoseconds wait = Clock::now() - start;
+    ++metrics.checkouts;
+    if (waited)
+        ++metrics.waits;
+    metrics.totalWaitTime += wait;
+    if (wait > metrics.maxWaitTime)
+        metrics.maxWaitTime = wait;
+}
+
+std::unique_ptr<Attachment> AttachmentPool::create() {
+    std::unique_ptr<Attachment> attachment(new Attachment());
+    attachment->setParameter(server, database, username, password, charset);
+    attachment->connect();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ++metrics.created;
+    return attachment;
+}
+
+void AttachmentPool::destroy(std::unique_ptr<Attachment> attachment) {
+    attachment->disconnect();
+    attachment.reset();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ++metrics.destroyed;
+}
+
+void AttachmentPool::giveBack(std::unique_ptr<Attachment> attachment, bool broken) {
+    std::vector<Slot> expired;
+    Clock::time_point now = Clock::now();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        --metrics.active;
+
+        if (broken || !attachment->isConnected())
+            --total;
+        else
+            idle.push_back({std::move(attachment), now});
+
+        takeExpired(expired, now);
+    }
+    available.notify_one();
+
+    if (attachment)
+        destroy(std::move(attachment));
+
+    for (auto &slot : expired)
+        destroy(std::move(slot.attachment));
+}
+
+void AttachmentPool::evictIdle() {
+    std::vector<Slot> expired;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        takeExpired(expired, Clock::now());
+    }
+
+    for (auto &slot : expired)
+        destroy(std::move(slot.attachment));
+}
+
+void AttachmentPool::takeExpired(std::vector<Slot>& expired, Clock::time_point now) {
+    //!! call with mutex locked
+    // idle is ordered by last use: the oldest connections are at the front
+    size_t n = 0;
+    while (n < idle.size() && total - n > options.minSize
+            && now - idle[n].lastUsed >= options.idleTimeout)
+        ++n;
+
+    for (size_t i = 0; i < n; ++i)
+        expired.push_back(std::move(idle[i]));
+
+    idle.erase(idle.begin(), idle.begin() + n);
+    total -= n;
+}
+
+const AttachmentPool::Options& AttachmentPool::getOptions() const {
+    return options;
+}
+
+AttachmentPool::Metrics AttachmentPool::getMetrics() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Metrics ret = metrics;
+    ret.idle = idle.size();
+    return ret;
+}
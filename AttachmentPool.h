@@ -0,0 +1,120 @@
+/* 
+ * File:   AttachmentPool.h
+ * Created on 17 ottobre 2026
+ */
+
+#ifndef ATTACHMENTPOOL_H
+#define ATTACHMENTPOOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Attachment.h"
+
+// Thread-safe pool of connected attachments.
+// acquire() hands out a Lease that gives the attachment back when destroyed;
+// transactions and statements using it must be released before the lease.
+class AttachmentPool {
+public:
+    struct Options {
+        size_t minSize = 1; // connections opened by the constructor and kept warm
+        size_t maxSize = 8;
+        std::chrono::milliseconds idleTimeout = std::chrono::minutes(5);
+        // ping connections idle for longer than this before handing them out
+        std::chrono::milliseconds validationInterval = std::chrono::seconds(30);
+    };
+
+    struct Metrics {
+        size_t active = 0;
+        size_t idle = 0;
+        uint64_t checkouts = 0;
+        uint64_t waits = 0; // checkouts that found the pool exhausted
+        uint64_t timeouts = 0;
+        uint64_t created = 0;
+        uint64_t destroyed = 0;
+        uint64_t validationFailures = 0;
+        std::chrono::nanoseconds totalWaitTime = std::chrono::nanoseconds::zero();
+        std::chrono::nanoseconds maxWaitTime = std::chrono::nanoseconds::zero();
+    };
+
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(Lease&& other);
+        Lease& operator=(Lease&& other);
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        virtual ~Lease();
+
+        explicit operator bool() const;
+        Attachment* get() const;
+        Attachment* operator->() const;
+        Attachment& operator*() const;
+
+        // the connection is broken: drop it instead of giving it back
+        void invalidate();
+        void release();
+    private:
+        friend class AttachmentPool;
+
+        Lease(AttachmentPool* pool, std::unique_ptr<Attachment> attachment);
+
+        AttachmentPool* pool = nullptr;
+        std::unique_ptr<Attachment> attachment;
+        bool broken = false;
+    };
+
+    AttachmentPool(std::string server, std::string database, std::string username,
+            std::string password, std::string charset);
+    AttachmentPool(std::string server, std::string database, std::string username,
+            std::string password, std::string charset, Options options);
+    AttachmentPool(const AttachmentPool&) = delete;
+    AttachmentPool& operator=(const AttachmentPool&) = delete;
+    virtual ~AttachmentPool();
+
+    // blocks until a connection is available
+    Lease acquire();
+    // returns an empty lease when no connection gets free within timeout
+    Lease acquire(std::chrono::milliseconds timeout);
+
+    // close connections idle for longer than idleTimeout, down to minSize.
+    // Also done when a lease is given back; the pool has no thread of its own,
+    // so a pool left quiet keeps its expired connections until this is called.
+    void evictIdle();
+
+    Metrics getMetrics() const;
+    const Options& getOptions() const;
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Slot {
+        std::unique_ptr<Attachment> attachment;
+        Clock::time_point lastUsed;
+    };
+
+    Lease acquire(const Clock::time_point* deadline);
+    void recordCheckout(Clock::time_point start, bool waited);
+    std::unique_ptr<Attachment> create();
+    void destroy(std::unique_ptr<Attachment> attachment);
+    void giveBack(std::unique_ptr<Attachment> attachment, bool broken);
+    void takeExpired(std::vector<Slot>& expired, Clock::time_point now);
+
+    std::string server;
+    std::string database;
+    std::string username;
+    std::string password;
+    std::string charset;
+    Options options;
+
+    mutable std::mutex mutex;
+    std::condition_variable available;
+    std::vector<Slot> idle; // most recently used last
+    size_t total = 0; // idle + active + being created
+    Metrics metrics;
+};
+
+#endif /* ATTACHMENTPOOL_H */
+
@@ -0,0 +1,226 @@
+/* 
+ * File:   Blob.cpp
+ * Created on 17 ottobre 2026
+ */
+
+#include <cstdio> // fopen, fread, fwrite
+#include "Blob.h"
+
+static const unsigned MAX_SEGMENT_SIZE = 65535;
+
+Blob::Blob() {
+    status = new ThrowStatusWrapper(master->getStatus());
+}
+
+Blob::~Blob() {
+    release();
+
+    if (status) {
+        status->dispose();
+        delete status;
+    }
+    if (transaction)
+        transaction->dispatcher.removeCallBack(transactionCallbackID);
+}
+
+void Blob::setTransaction(Transaction* transaction) {
+    if (this->transaction == transaction)
+        return;
+
+    if (this->transaction)
+        this->transaction->dispatcher.removeCallBack(transactionCallbackID);
+
+    release();
+
+    this->transaction = transaction;
+
+    transactionCallbackID = transaction->dispatcher.addCallBack([this](DBStateEvents evt) {
+        switch (evt) {
+            case DBStateEvents::TRANSACTION_DISCONNECT:
+            case DBStateEvents::ATTACHMENT_DISCONNECT:
+            case DBStateEvents::ATTACHMENT_DELETE:
+                release();
+                break;
+            case DBStateEvents::TRANSACTION_DELETE:
+                release();
+                this->transaction = nullptr;
+                break;
+
+            default:
+                break;
+        }
+    });
+}
+
+void Blob::checkTransaction() {
+    if (!transaction)
+        throw std::logic_error("Blob: set transaction before !");
+
+    transaction->connect();
+}
+
+void Blob::release() {
+    // a blob still open when the transaction ends is closed, so written data is kept
+    try {
+        close();
+    } catch (const FbException& e) {
+        if (blob_) {
+            blob_->release();
+            blob_ = nullptr;
+        }
+
+        char buf[256];
+        formatExceptionMessage(e, buf, 256);
+        fprintf(stderr, "%s\n", buf);
+    }
+}
+
+void Blob::open(const ISC_QUAD& id) {
+    if (blob_)
+        throw std::logic_error("Blob: close before open!");
+
+    checkTransaction();
+
+    this->id = id;
+    eof = false;
+    blob_ = transaction->attachment->att_->openBlob(status, transaction->tra_, &this->id, 0, nullptr);
+}
+
+void Blob::create(bool stream) {
+    if (blob_)
+        throw std::logic_error("Blob: close before create!");
+
+    checkTransaction();
+
+    const unsigned char bpb[] = {isc_bpb_version1, isc_bpb_type, 1, isc_bpb_type_stream};
+
+    eof = false;
+    blob_ = transaction->attachment->att_->createBlob(status, transaction->tra_, &id,
+            stream ? sizeof (bpb) : 0, stream ? bpb : nullptr);
+}
+
+void Blob::close() {
+    if (blob_) {
+        blob_->close(status);
+        blob_ = nullptr;
+    }
+}
+
+void Blob::cancel() {
+    if (blob_) {
+        blob_->cancel(status);
+        blob_ = nullptr;
+    }
+}
+
+bool Blob::isOpen() {
+    return blob_ != nullptr;
+}
+
+const ISC_QUAD& Blob::getId() const {
+    return id;
+}
+
+unsigned Blob::read(void* buffer, unsigned len) {
+    if (!blob_)
+        throw std::logic_error("Blob: call open before!");
+
+    unsigned char* p = (unsigned char*) buffer;
+    unsigned total = 0;
+
+    while (total < len && !eof) {
+        unsigned chunk = len - total < MAX_SEGMENT_SIZE ? len - total : MAX_SEGMENT_SIZE;
+        unsigned got = 0;
+
+        switch (blob_->getSegment(status, chunk, p + total, &got)) {
+            case IStatus::RESULT_OK:
+            case IStatus::RESULT_SEGMENT:
+                total += got;
+                break;
+            default:
+                eof = true;
+                break;
+        }
+    }
+    return total;
+}
+
+void Blob::write(const void* buffer, unsigned len) {
+    if (!blob_)
+        throw std::logic_error("Blob: call create before!");
+
+    const unsigned char* p = (const unsigned char*) buffer;
+
+    while (len > 0) {
+        unsigned chunk = len < segmentSize ? len : segmentSize;
+        blob_->putSegment(status, chunk, p);
+        p += chunk;
+        len -= chunk;
+    }
+}
+
+int Blob::seek(Whence whence, int offset) {
+    if (!blob_)
+        throw std::logic_error("Blob: call open before!");
+
+    eof = false;
+    return blob_->seek(status, (int) whence, offset);
+}
+
+void Blob::setSegmentSize(unsigned size) {
+    if (size == 0 || size > MAX_SEGMENT_SIZE)
+        throw std::invalid_argument("Blob: invalid segment size!");
+
+    segmentSize = size;
+}
+
+uint64_t Blob::readToFile(const char* path) {
+    FILE* f = fopen(path, "wb");
+    if (!f)
+        throw std::runtime_error(std::string("Blob: cannot open ") + path);
+
+    buffer.resize(segmentSize);
+    uint64_t total = 0;
+    unsigned n;
+
+    try {
+        while ((n = read(buffer.data(), segmentSize)) > 0) {
+            if (fwrite(buffer.data(), 1, n, f) != n)
+                throw std::runtime_error(std::string("Blob: cannot write ") + path);
+            total += n;
+        }
+    } catch (...) {
+        fclose(f);
+        throw;
+    }
+
+    if (fclose(f) != 0)
+        throw std::runtime_error(std::string("Blob: cannot write ") + path);
+
+    return total;
+}
+
+uint64_t Blob::writeFromFile(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f)
+        throw std::runtime_error(std::string("Blob: cannot open ") + path);
+
+    buffer.resize(segmentSize);
+    uint64_t total = 0;
+    size_t n;
+
+    try {
+        while ((n = fread(buffer.data(), 1, segmentSize, f)) > 0) {
+            write(buffer.data(), n);
+            total += n;
+        }
+        if (ferror(f))
+            throw std::runtime_error(std::string("Blob: cannot read ") + path);
+    } catch (...) {
+        fclose(f);
+        throw;
+    }
+
+    fclose(f);
+    return total;
+}
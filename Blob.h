@@ -0,0 +1,62 @@
+/* 
+ * File:   Blob.h
+ * Created on 17 ottobre 2026
+ */
+
+#ifndef BLOB_H
+#define BLOB_H
+
+#include <cstdint>
+#include <vector>
+#include "Transaction.h"
+
+// Streaming access to a BLOB: data goes through caller buffers segment by
+// segment, so a blob never has to fit in memory.
+class Blob {
+public:
+    enum class Whence {
+        BEGIN = 0,
+        CURRENT = 1,
+        END = 2
+    };
+
+    Blob();
+    Blob(const Blob&) = delete;
+    Blob& operator=(const Blob&) = delete;
+    virtual ~Blob();
+    void setTransaction(Transaction* transaction);
+
+    void open(const ISC_QUAD& id);
+    // stream blobs can be positioned with seek()
+    void create(bool stream = false);
+    void close();
+    void cancel();
+    bool isOpen();
+    const ISC_QUAD& getId() const;
+
+    // reads up to len bytes, returns 0 at the end of the blob
+    unsigned read(void* buffer, unsigned len);
+    void write(const void* buffer, unsigned len);
+    int seek(Whence whence, int offset);
+
+    // segment size of write() and of the file transfers, at most 65535
+    void setSegmentSize(unsigned size);
+    uint64_t readToFile(const char* path);
+    uint64_t writeFromFile(const char* path);
+private:
+    void checkTransaction();
+    void release();
+
+    Transaction* transaction = nullptr;
+    IBlob* blob_ = nullptr;
+    ThrowStatusWrapper* status = nullptr;
+    ISC_QUAD id = {0, 0};
+    bool eof = false;
+    unsigned segmentSize = 65535;
+    std::vector<unsigned char> buffer; // reused by the file transfers
+
+    EventDispatcher<DBStateEvents>::CBID transactionCallbackID;
+};
+
+#endif /* BLOB_H */
+
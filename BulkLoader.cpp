@@ -0,0 +1,857 @@
+/*
+ * File:   BulkLoader.cpp
+ * Created on 17 ottobre 2026
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv> // from_chars
+#include <condition_variable>
+#include <cstring> // memcpy, memchr
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string_view>
+#include <system_error>
+#include <fcntl.h> // open
+#include <sys/mman.h> // mmap
+#include <sys/stat.h> // fstat
+#include <unistd.h> // close
+#include "BulkLoader.h"
+#include "DateTime.h"
+
+typedef std::chrono::steady_clock Clock;
+
+namespace {
+
+    // input message layout of a column
+    struct Column {
+        unsigned type;
+        unsigned length;
+        unsigned offset;
+        unsigned nullOffset;
+        int scale;
+    };
+}
+
+struct BulkLoader::Chunk {
+    const char* begin;
+    const char* end;
+    uint64_t firstLine;
+};
+
+// parsed rows of a chunk, in input message layout
+struct BulkLoader::Block {
+    std::vector<unsigned char> messages;
+    std::vector<uint64_t> lines;
+    std::vector<std::string_view> records; // source text, for the rejects
+    unsigned rows = 0;
+};
+
+/*********************************************************
+ * Stage
+ */
+double BulkLoader::Stage::rowsPerSecond() const {
+    return wall.count() ? rows * 1e9 / wall.count() : 0;
+}
+
+double BulkLoader::Stage::megabytesPerSecond() const {
+    return wall.count() ? bytes * 1e9 / wall.count() / (1024 * 1024) : 0;
+}
+
+/*********************************************************
+ * Field conversion
+ */
+static std::string_view trim(std::string_view s) {
+    while (!s.empty() && s.front() == ' ')
+        s.remove_prefix(1);
+    while (!s.empty() && s.back() == ' ')
+        s.remove_suffix(1);
+    return s;
+}
+
+static bool equalsIgnoreCase(std::string_view s, std::string_view lower) {
+    if (s.size() != lower.size())
+        return false;
+    for (size_t j = 0; j < s.size(); ++j) {
+        if ((s[j] | 0x20) != lower[j])
+            return false;
+    }
+    return true;
+}
+
+template <typename T>
+static void store(unsigned char* p, T v) {
+    std::memcpy(p, &v, sizeof (T));
+}
+
+// decimal text scaled by 10^-scale, no rounding
+static bool parseScaled(std::string_view s, int scale, int64_t& value) {
+    bool negative = false;
+    if (!s.empty() && (s.front() == '-' || s.front() == '+')) {
+        negative = s.front() == '-';
+        s.remove_prefix(1);
+    }
+    if (s.empty())
+        return false;
+
+    uint64_t v = 0;
+    int decimals = -1; // digits after the point, -1 without point
+    bool digits = false;
+    for (char c : s) {
+        if (c == '.' && decimals < 0) {
+            decimals = 0;
+            continue;
+        }
+        if (c < '0' || c > '9')
+            return false;
+        digits = true;
+
+        if (decimals >= 0 && decimals >= -scale) {
+            if (c != '0')
+                return false; // more decimals than the column holds
+            continue;
+        }
+        if (__builtin_mul_overflow(v, 10, &v) || __builtin_add_overflow(v, uint64_t(c - '0'), &v))
+            return false;
+        if (decimals >= 0)
+            ++decimals;
+    }
+    if (!digits)
+        return false;
+
+    for (int j = decimals < 0 ? 0 : decimals; j < -scale; ++j) {
+        if (__builtin_mul_overflow(v, 10, &v))
+            return false;
+    }
+
+    if (v > (uint64_t) INT64_MAX + negative)
+        return false;
+    value = negative ? (int64_t) (0 - v) : (int64_t) v;
+    return true;
+}
+
+static bool parseUnsigned(std::string_view& s, unsigned digits, unsigned& value) {
+    if (s.size() < digits)
+        return false;
+    auto r = std::from_chars(s.data(), s.data() + digits, value);
+    if (r.ec != std::errc() || r.ptr != s.data() + digits)
+        return false;
+    s.remove_prefix(digits);
+    return true;
+}
+
+static bool expect(std::string_view& s, char c) {
+    if (s.empty() || s.front() != c)
+        return false;
+    s.remove_prefix(1);
+    return true;
+}
+
+// YYYY-MM-DD as days from 1858-11-17
+static bool parseDate(std::string_view& s, ISC_DATE& date) {
+    unsigned y, m, d;
+    if (!parseUnsigned(s, 4, y) || !expect(s, '-') || !parseUnsigned(s, 2, m) || !expect(s, '-')
+            || !parseUnsigned(s, 2, d))
+        return false;
+    if (y < 1 || m < 1 || m > 12 || d < 1 || d > 31)
+        return false;
+
+    // a day past the end of the month rolls over into the next one
+    date = DateTime::date(y, m, d);
+    int64_t year;
+    unsigned month, day;
+    DateTime::civil(date, year, month, day);
+    return day == d;
+}
+
+// HH:MM[:SS[.ffff]] in 1/10000 of second
+static bool parseTime(std::string_view& s, ISC_TIME& time) {
+    unsigned h, m, sec = 0, fraction = 0;
+    if (!parseUnsigned(s, 2, h) || !expect(s, ':') || !parseUnsigned(s, 2, m))
+        return false;
+
+    if (expect(s, ':')) {
+        if (!parseUnsigned(s, 2, sec))
+            return false;
+        if (expect(s, '.')) {
+            unsigned scale = 1000;
+            if (s.empty())
+                return false;
+            while (!s.empty() && s.front() >= '0' && s.front() <= '9') {
+                fraction += (s.front() - '0') * scale;
+                scale /= 10;
+                s.remove_prefix(1);
+            }
+        }
+    }
+    if (h > 23 || m > 59 || sec > 59)
+        return false;
+
+    time = ((h * 60 + m) * 60 + sec) * 10000 + fraction;
+    return true;
+}
+
+// text is the field content, quoted fields can hold an empty string
+static const char* convert(const Column& c, std::string_view text, bool quoted,
+        unsigned char* message) {
+    unsigned char* v = message + c.offset;
+
+    if (text.empty() && (!quoted || (c.type != SQL_TEXT && c.type != SQL_VARYING))) {
+        store<short>(message + c.nullOffset, -1);
+        return nullptr;
+    }
+    store<short>(message + c.nullOffset, 0);
+
+    switch (c.type) {
+        case SQL_TEXT:
+            if (text.size() > c.length)
+                return "value too long";
+            std::memcpy(v, text.data(), text.size());
+            std::memset(v + text.size(), ' ', c.length - text.size());
+            return nullptr;
+        case SQL_VARYING:
+            if (text.size() > c.length)
+                return "value too long";
+            store<unsigned short>(v, text.size());
+            std::memcpy(v + sizeof (short), text.data(), text.size());
+            return nullptr;
+        default:
+            break;
+    }
+
+    text = trim(text);
+    switch (c.type) {
+        case SQL_SHORT:
+        case SQL_LONG:
+        case SQL_INT64: {
+            int64_t n;
+            if (!parseScaled(text, c.scale, n))
+                return "invalid number";
+            if (c.type == SQL_SHORT) {
+                if (n < INT16_MIN || n > INT16_MAX)
+                    return "number out of range";
+                store<ISC_SHORT>(v, n);
+            } else if (c.type == SQL_LONG) {
+                if (n < INT32_MIN || n > INT32_MAX)
+                    return "number out of range";
+                store<ISC_LONG>(v, n);
+            } else
+                store<ISC_INT64>(v, n);
+            return nullptr;
+        }
+        case SQL_INT128:
+        case SQL_DEC16:
+        case SQL_DEC34:
+            try {
+                ParameterWriter<Decimal>::write(v, c.type, c.length, c.scale, Decimal::parse(text));
+            } catch (const std::invalid_argument&) {
+                return "invalid number";
+            } catch (const std::out_of_range&) {
+                return "number out of range";
+            }
+            return nullptr;
+        case SQL_FLOAT:
+        case SQL_DOUBLE: {
+            if (!text.empty() && text.front() == '+')
+                text.remove_prefix(1);
+            double d;
+            auto r = std::from_chars(text.data(), text.data() + text.size(), d);
+            if (r.ec != std::errc() || r.ptr != text.data() + text.size())
+                return "invalid number";
+            if (c.type == SQL_FLOAT)
+                store<float>(v, d);
+            else
+                store<double>(v, d);
+            return nullptr;
+        }
+        case SQL_BOOLEAN:
+            if (text == "1" || equalsIgnoreCase(text, "t") || equalsIgnoreCase(text, "true"))
+                *v = 1;
+            else if (text == "0" || equalsIgnoreCase(text, "f") || equalsIgnoreCase(text, "false"))
+                *v = 0;
+            else
+                return "invalid boolean";
+            return nullptr;
+        case SQL_TYPE_DATE: {
+            ISC_DATE d;
+            if (!parseDate(text, d) || !text.empty())
+                return "invalid date";
+            store<ISC_DATE>(v, d);
+            return nullptr;
+        }
+        case SQL_TYPE_TIME: {
+            ISC_TIME t;
+            if (!parseTime(text, t) || !text.empty())
+                return "invalid time";
+            store<ISC_TIME>(v, t);
+            return nullptr;
+        }
+        case SQL_TIMESTAMP: {
+            ISC_TIMESTAMP ts;
+            ts.timestamp_time = 0;
+            if (!parseDate(text, ts.timestamp_date))
+                return "invalid timestamp";
+            if (!text.empty() && (text.front() == ' ' || text.front() == 'T')) {
+                text.remove_prefix(1);
+                if (!parseTime(text, ts.timestamp_time))
+                    return "invalid timestamp";
+            }
+            if (!text.empty())
+                return "invalid timestamp";
+            store<ISC_TIMESTAMP>(v, ts);
+            return nullptr;
+        }
+        default:
+            return "unsupported data type";
+    }
+}
+
+/*********************************************************
+ * Pipeline
+ */
+namespace {
+
+    class FileMapping {
+    public:
+        explicit FileMapping(const std::string& path) {
+            fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                throw std::system_error(errno, std::generic_category(), "BulkLoader: open " + path);
+
+            struct stat st;
+            if (fstat(fd, &st) < 0) {
+                int e = errno;
+                ::close(fd);
+                throw std::system_error(e, std::generic_category(), "BulkLoader: stat " + path);
+            }
+            size = st.st_size;
+
+            if (size) {
+                void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p == MAP_FAILED) {
+                    int e = errno;
+                    ::close(fd);
+                    throw std::system_error(e, std::generic_category(), "BulkLoader: mmap " + path);
+                }
+                madvise(p, size, MADV_SEQUENTIAL);
+                data = (const char*) p;
+            }
+        }
+
+        FileMapping(const FileMapping&) = delete;
+        FileMapping& operator=(const FileMapping&) = delete;
+
+        ~FileMapping() {
+            if (data)
+                munmap((void*) data, size);
+            ::close(fd);
+        }
+
+        const char* data = nullptr;
+        size_t size = 0;
+    private:
+        int fd = -1;
+    };
+
+    // per thread timing merged into a stage
+    struct StageClock {
+        Clock::time_point first = Clock::time_point::max();
+        Clock::time_point last = Clock::time_point::min();
+        std::chrono::nanoseconds busy{0};
+
+        void add(Clock::time_point start, Clock::time_point end) {
+            first = std::min(first, start);
+            last = std::max(last, end);
+            busy += end - start;
+        }
+
+        void merge(const StageClock& other) {
+            first = std::min(first, other.first);
+            last = std::max(last, other.last);
+            busy += other.busy;
+        }
+
+        void report(BulkLoader::Stage& stage) const {
+            stage.busy = busy;
+            stage.wall = last > first ? last - first : std::chrono::nanoseconds(0);
+        }
+    };
+}
+
+class BulkLoader::Pipeline {
+public:
+    Pipeline(BulkLoader& loader, Report& report) : loader(loader), report(report) {
+    }
+
+    // record boundaries near every chunkSize bytes, outside quotes
+    void split(const char* begin, const char* end) {
+        const char quote = loader.options.quote;
+        uint64_t line = 1;
+        const char* p = begin;
+
+        if (loader.options.header && p < end) {
+            const char* nl = (const char*) std::memchr(p, '\n', end - p);
+            p = nl ? nl + 1 : end;
+            line = 2;
+        }
+
+        while (p < end) {
+            const char* target = end - p > (ptrdiff_t) loader.options.chunkSize ? p + loader.options.chunkSize : end;
+
+            // quote parity up to the target, then the first new line outside quotes
+            bool inQuotes = std::count(p, target, quote) % 2;
+            const char* q = target;
+            while (q < end && (inQuotes || *q != '\n')) {
+                if (*q == quote)
+                    inQuotes = !inQuotes;
+                ++q;
+            }
+            const char* chunkEnd = q < end ? q + 1 : end;
+
+            chunks.push_back({p, chunkEnd, line});
+            line += std::count(p, chunkEnd, '\n');
+            p = chunkEnd;
+        }
+    }
+
+    void parse() {
+        StageClock clock;
+        uint64_t rows = 0, bytes = 0;
+        Fields fields;
+
+        for (;;) {
+            size_t i = nextChunk.fetch_add(1);
+            if (i >= chunks.size() || failed.load())
+                break;
+
+            Clock::time_point start = Clock::now();
+            Block block = parseChunk(chunks[i], fields);
+            clock.add(start, Clock::now());
+            rows += block.rows;
+            bytes += chunks[i].end - chunks[i].begin;
+
+            if (!push(std::move(block)))
+                break;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        parseClock.merge(clock);
+        report.parse.rows += rows;
+        report.parse.bytes += bytes;
+        if (--activeParsers == 0) {
+            closed = true;
+            notEmpty.notify_all();
+        }
+    }
+
+    void load(const std::string& sql) {
+        StageClock clock;
+        uint64_t rows = 0, bytes = 0, loaded = 0;
+
+        AttachmentPool::Lease lease = loader.pool.acquire();
+        {
+            Transaction transaction;
+            transaction.setAttachment(lease.get());
+            Statement statement;
+            statement.setTransaction(&transaction);
+            statement.setSql(sql);
+            statement.setBatchBufferSize(loader.options.batchBufferSize);
+
+            Block block;
+            while (pop(block)) {
+                Clock::time_point start = Clock::now();
+                statement.addMessages(block.messages.data(), block.rows);
+                Statement::BatchResult result = statement.executeBatch();
+                transaction.commit();
+                clock.add(start, Clock::now());
+
+                rows += block.rows;
+                bytes += block.messages.size();
+                loaded += block.rows - result.errors.size();
+                for (const auto &e : result.errors)
+                    reject(block.lines[e.first], e.second, block.records[e.first]);
+            }
+            statement.reset();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        loadClock.merge(clock);
+        report.load.rows += rows;
+        report.load.bytes += bytes;
+        report.rowsLoaded += loaded;
+    }
+
+    void fail() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error)
+                error = std::current_exception();
+            closed = true;
+        }
+        failed = true;
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+
+    BulkLoader& loader;
+    Report& report;
+    std::vector<Column> columns;
+    unsigned stride = 0; // aligned message length
+    std::vector<Chunk> chunks;
+    std::atomic<size_t> nextChunk{0};
+    unsigned activeParsers = 0;
+    StageClock parseClock;
+    StageClock loadClock;
+    std::exception_ptr error;
+private:
+    // fields of the current record, reused by the parser thread
+    struct Fields {
+        std::vector<std::string_view> text;
+        std::vector<bool> quoted;
+        std::string scratch; // unescaped quoted fields
+        std::vector<std::pair<size_t, size_t> > unescaped; // field, offset in scratch
+    };
+
+    Block parseChunk(const Chunk& chunk, Fields& f) {
+        Block block;
+        const char delimiter = loader.options.delimiter;
+        const char quote = loader.options.quote;
+        uint64_t line = chunk.firstLine;
+        const char* p = chunk.begin;
+
+        while (p < chunk.end) {
+            const char* record = p;
+            const uint64_t recordLine = line;
+            const char* error = nullptr;
+            f.text.clear();
+            f.quoted.clear();
+            f.scratch.clear();
+            f.unescaped.clear();
+
+            for (;;) {
+                if (p < chunk.end && *p == quote) {
+                    size_t start = f.scratch.size();
+                    ++p;
+                    for (;;) {
+                        const char* q = (const char*) std::memchr(p, quote, chunk.end - p);
+                        if (!q) {
+                            error = "unterminated quote";
+                            p = chunk.end;
+                            break;
+                        }
+                        line += std::count(p, q, '\n');
+                        f.scratch.append(p, q - p);
+                        p = q + 1;
+                        if (p < chunk.end && *p == quote) {
+                            f.scratch += quote;
+                            ++p;
+                        } else
+                            break;
+                    }
+                    // scratch may still move: the view is set when the record is complete
+                    f.unescaped.emplace_back(f.text.size(), start);
+                    f.text.emplace_back();
+                    f.quoted.push_back(true);
+                } else {
+                    const char* q = p;
+                    while (q < chunk.end && *q != delimiter && *q != '\n')
+                        ++q;
+                    const char* e = q > p && q[-1] == '\r' && (q == chunk.end || *q == '\n') ? q - 1 : q;
+                    f.text.emplace_back(p, e - p);
+                    f.quoted.push_back(false);
+                    p = q;
+                }
+
+                if (p < chunk.end && *p == delimiter) {
+                    ++p;
+                    continue;
+                }
+                if (p < chunk.end && *p == '\r')
+                    ++p;
+                if (p < chunk.end && *p == '\n') {
+                    ++p;
+                    ++line;
+                } else if (p < chunk.end && !error) {
+                    error = "unexpected character after quoted field";
+                    while (p < chunk.end && *p != '\n')
+                        ++p;
+                    if (p < chunk.end) {
+                        ++p;
+                        ++line;
+                    }
+                }
+                break;
+            }
+
+            std::string_view text(record, p - record);
+            while (!text.empty() && (text.back() == '\n' || text.back() == '\r'))
+                text.remove_suffix(1);
+
+            // blank line
+            if (f.text.size() == 1 && !f.quoted[0] && f.text[0].empty())
+                continue;
+
+            for (size_t j = 0; j < f.unescaped.size(); ++j) {
+                size_t begin = f.unescaped[j].second;
+                size_t end = j + 1 < f.unescaped.size() ? f.unescaped[j + 1].second : f.scratch.size();
+                f.text[f.unescaped[j].first] = std::string_view(f.scratch.data() + begin, end - begin);
+            }
+
+            if (!error && f.text.size() != columns.size())
+                error = "wrong number of fields";
+
+            if (!error) {
+                size_t offset = block.messages.size();
+                block.messages.resize(offset + stride);
+                unsigned char* message = block.messages.data() + offset;
+                for (size_t j = 0; j < columns.size() && !error; ++j)
+                    error = convert(columns[j], f.text[j], f.quoted[j], message);
+                if (error)
+                    block.messages.resize(offset);
+            }
+
+            if (error) {
+                reject(recordLine, error, text);
+                continue;
+            }
+
+            block.lines.push_back(recordLine);
+            block.records.push_back(text);
+            ++block.rows;
+        }
+
+        return block;
+    }
+
+    void reject(uint64_t line, const std::string& reason, std::string_view text) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (++report.rowsRejected > loader.options.maxRejected) {
+            if (!error)
+                error = std::make_exception_ptr(std::runtime_error("BulkLoader: too many rejected rows!"));
+            closed = true;
+            failed = true;
+            notEmpty.notify_all();
+            notFull.notify_all();
+        }
+
+        Rejected r{line, reason, std::string(text)};
+        if (loader.rejectHandler)
+            loader.rejectHandler(r);
+        else if (report.rejected.size() < 1000)
+            report.rejected.push_back(std::move(r));
+    }
+
+    bool push(Block block) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [this] {
+            return failed || queue.size() < capacity();
+        });
+        if (failed)
+            return false;
+
+        queue.push_back(std::move(block));
+        notEmpty.notify_one();
+        return true;
+    }
+
+    bool pop(Block& block) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [this] {
+            return failed || closed || !queue.empty();
+        });
+        if (failed || queue.empty())
+            return false;
+
+        block = std::move(queue.front());
+        queue.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    size_t capacity() const {
+        return 2 * loader.options.loaders + 2;
+    }
+
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::deque<Block> queue;
+    bool closed = false;
+    std::atomic<bool> failed{false};
+};
+
+// name as stored in the system tables: "Name" keeps its case, Name is uppercased
+static std::string identifierName(const std::string& name) {
+    std::string result;
+    if (name.size() >= 2 && name.front() == '"' && name.back() == '"') {
+        for (size_t j = 1; j + 1 < name.size(); ++j) {
+            result += name[j];
+            if (name[j] == '"' && name[j + 1] == '"')
+                ++j;
+        }
+    } else {
+        for (char c : name)
+            result += (c >= 'a' && c <= 'z') ? char(c - 'a' + 'A') : c;
+    }
+    if (result.empty())
+        throw std::invalid_argument("BulkLoader: empty name!");
+    return result;
+}
+
+static std::string quotedIdentifier(const std::string& name) {
+    std::string result = "\"";
+    for (char c : name) {
+        result += c;
+        if (c == '"')
+            result += c;
+    }
+    return result + '"';
+}
+
+/*********************************************************
+ * BulkLoader
+ */
+BulkLoader::BulkLoader(AttachmentPool& pool) : pool(pool) {
+}
+
+void BulkLoader::setTable(std::string table) {
+    this->table = identifierName(table);
+}
+
+void BulkLoader::setColumns(std::vector<std::string> columns) {
+    for (std::string& name : columns)
+        name = identifierName(name);
+    this->columns = std::move(columns);
+}
+
+void BulkLoader::setOptions(const Options& options) {
+    checkOptions(options);
+    this->options = options;
+}
+
+// without parsers the queue is never closed, without loaders never drained
+void BulkLoader::checkOptions(const Options& options) {
+    if (options.parsers == 0 || options.loaders == 0 || options.chunkSize == 0)
+        throw std::invalid_argument("BulkLoader: invalid options!");
+}
+
+void BulkLoader::setRejectHandler(RejectHandler handler) {
+    rejectHandler = std::move(handler);
+}
+
+std::string BulkLoader::insertSql(Transaction& transaction) {
+    std::vector<std::string> names = columns;
+
+    if (names.empty()) {
+        Statement statement;
+        statement.setTransaction(&transaction);
+        statement.setSql("SELECT TRIM(RF.RDB$FIELD_NAME) FROM RDB$RELATION_FIELDS RF "
+                "JOIN RDB$FIELDS F ON F.RDB$FIELD_NAME = RF.RDB$FIELD_SOURCE "
+                "WHERE RF.RDB$RELATION_NAME = ? AND F.RDB$COMPUTED_BLR IS NULL "
+                "ORDER BY RF.RDB$FIELD_POSITION");
+        statement.parameter(0).setText(table.c_str());
+        statement.open();
+        while (statement.fetch())
+            names.push_back(statement.field(0).asString());
+        statement.close();
+
+        if (names.empty())
+            throw std::invalid_argument("BulkLoader: unknown table " + table + "!");
+    }
+
+    std::string sql = "INSERT INTO " + quotedIdentifier(table) + " (";
+    std::string values;
+    for (size_t j = 0; j < names.size(); ++j) {
+        sql += (j ? ", " : "") + quotedIdentifier(names[j]);
+        values += j ? ", ?" : "?";
+    }
+    return sql + ") VALUES (" + values + ")";
+}
+
+BulkLoader::Report BulkLoader::load(const std::string& path) {
+    if (table.empty())
+        throw std::logic_error("BulkLoader: set table before load!");
+    checkOptions(options);
+
+    Clock::time_point started = Clock::now();
+    Report report;
+    Pipeline pipeline(*this, report);
+    std::string sql;
+
+    // message layout from a statement prepared on the first attachment
+    {
+        AttachmentPool::Lease lease = pool.acquire();
+        Transaction transaction;
+        transaction.setAttachment(lease.get());
+        Statement statement;
+        statement.setTransaction(&transaction);
+
+        sql = insertSql(transaction);
+        statement.setSql(sql);
+        pipeline.stride = statement.getParametersAlignedLength();
+
+        for (unsigned j = 0; j < statement.parametersCount; ++j) {
+            const Statement::Parameter& p = statement.parameters[j];
+            Column c{p.type, p.length, p.offset, p.nullOffset, p.scale};
+
+            switch (c.type) {
+                case SQL_TEXT: case SQL_VARYING: case SQL_SHORT: case SQL_LONG: case SQL_INT64:
+                case SQL_INT128: case SQL_DEC16: case SQL_DEC34:
+                case SQL_FLOAT: case SQL_DOUBLE: case SQL_BOOLEAN:
+                case SQL_TYPE_DATE: case SQL_TYPE_TIME: case SQL_TIMESTAMP:
+                    break;
+                default:
+                    throw std::invalid_argument("BulkLoader: unsupported data type for column "
+                        + std::to_string(j) + "!");
+            }
+            pipeline.columns.push_back(c);
+        }
+
+        statement.reset();
+        transaction.commit();
+    }
+
+    FileMapping file(path);
+
+    Clock::time_point start = Clock::now();
+    pipeline.split(file.data, file.data + file.size);
+    report.split.rows = pipeline.chunks.size();
+    report.split.bytes = file.size;
+    report.split.wall = report.split.busy = Clock::now() - start;
+
+    std::vector<std::thread> threads;
+    pipeline.activeParsers = options.parsers;
+    for (unsigned j = 0; j < options.parsers; ++j) {
+        threads.emplace_back([&pipeline] {
+            try {
+                pipeline.parse();
+            } catch (...) {
+                pipeline.fail();
+            }
+        });
+    }
+    for (unsigned j = 0; j < options.loaders; ++j) {
+        threads.emplace_back([&pipeline, &sql] {
+            try {
+                pipeline.load(sql);
+            } catch (...) {
+                pipeline.fail();
+            }
+        });
+    }
+
+    for (auto &thread : threads)
+        thread.join();
+
+    if (pipeline.error)
+        std::rethrow_exception(pipeline.error);
+
+    pipeline.parseClock.report(report.parse);
+    pipeline.loadClock.report(report.load);
+    report.rowsRead = report.parse.rows + report.rowsRejected - (report.load.rows - report.rowsLoaded);
+    report.elapsed = Clock::now() - started;
+    return report;
+}
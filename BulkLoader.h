@@ -0,0 +1,91 @@
+/*
+ * File:   BulkLoader.h
+ * Created on 17 ottobre 2026
+ */
+
+#ifndef BULKLOADER_H
+#define BULKLOADER_H
+
+#include <algorithm> // max
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AttachmentPool.h"
+#include "Statement.h"
+
+// Loads a delimited text file into a table as a pipeline: the file is mapped
+// and split into chunks at record boundaries, parser threads convert the
+// fields straight into input messages, and loader threads, each on its own
+// attachment from the pool, send them through IBatch and commit every chunk.
+// Rows that fail conversion or insertion are rejected, the load goes on.
+class BulkLoader {
+public:
+    struct Options {
+        char delimiter = ',';
+        char quote = '"';
+        bool header = true; // skip the first line
+        unsigned parsers = std::max(1u, std::thread::hardware_concurrency()); // 0 when unknown
+        unsigned loaders = 1; // attachments taken from the pool
+        size_t chunkSize = 4 * 1024 * 1024;
+        unsigned batchBufferSize = 8 * 1024 * 1024;
+        uint64_t maxRejected = UINT64_MAX; // the load fails past this
+    };
+
+    struct Rejected {
+        uint64_t line; // first line of the record, 1 based
+        std::string reason;
+        std::string text;
+    };
+
+    struct Stage {
+        uint64_t rows = 0;
+        uint64_t bytes = 0;
+        std::chrono::nanoseconds busy{0}; // summed over the threads of the stage
+        std::chrono::nanoseconds wall{0}; // first start to last end
+
+        double rowsPerSecond() const;
+        double megabytesPerSecond() const;
+    };
+
+    struct Report {
+        uint64_t rowsRead = 0;
+        uint64_t rowsLoaded = 0;
+        uint64_t rowsRejected = 0;
+        Stage split;
+        Stage parse;
+        Stage load;
+        std::chrono::nanoseconds elapsed{0};
+        std::vector<Rejected> rejected; // first ones, when no reject handler is set
+    };
+
+    // called on a pipeline thread, one call at a time
+    typedef std::function<void(const Rejected&)> RejectHandler;
+
+    explicit BulkLoader(AttachmentPool& pool);
+    // names as in SQL: "Name" keeps its case, Name is uppercased
+    void setTable(std::string table);
+    // column list of the file, all the table columns when empty
+    void setColumns(std::vector<std::string> columns);
+    void setOptions(const Options& options);
+    void setRejectHandler(RejectHandler handler);
+
+    Report load(const std::string& path);
+private:
+    struct Chunk;
+    struct Block;
+    class Pipeline;
+
+    static void checkOptions(const Options& options);
+    std::string insertSql(Transaction& transaction);
+
+    AttachmentPool& pool;
+    std::string table;
+    std::vector<std::string> columns;
+    Options options;
+    RejectHandler rejectHandler;
+};
+
+#endif /* BULKLOADER_H */
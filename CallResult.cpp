@@ -0,0 +1,31 @@
+/*
+ * File:   CallResult.cpp
+ * Created on 17 ottobre 2026
+ */
+
+#include "CallResult.h"
+#include "Transaction.h"
+
+CallResult::CallResult(const ISC_STATUS* errors) : failed(true) {
+    if (errors[0] == isc_arg_gds)
+        code = errors[1];
+    conflict = Transaction::isConflict(errors);
+    fb_sqlstate(state, errors);
+}
+
+namespace {
+
+    struct ThreadStatus {
+        CheckStatusWrapper wrapper{master->getStatus()};
+
+        ~ThreadStatus() {
+            wrapper.dispose();
+        }
+    };
+}
+
+CheckStatusWrapper* CallResult::status() {
+    thread_local ThreadStatus status;
+    status.wrapper.init();
+    return &status.wrapper;
+}
@@ -0,0 +1,52 @@
+/*
+ * File:   CallResult.h
+ * Created on 17 ottobre 2026
+ */
+
+#ifndef CALLRESULT_H
+#define CALLRESULT_H
+
+#include "fb-wrapper.h"
+
+// Outcome of the try* calls, which report errors through a CheckStatusWrapper
+// instead of throwing FbException: the primary GDS code and the SQLSTATE are
+// copied out of the status vector, nothing is allocated.
+class CallResult {
+public:
+    // success
+    CallResult() = default;
+    explicit CallResult(const ISC_STATUS* errors);
+
+    bool ok() const {
+        return !failed;
+    }
+
+    explicit operator bool() const {
+        return !failed;
+    }
+
+    // isc_xxx, e.g. isc_unique_key_violation; 0 on success
+    ISC_STATUS gdsCode() const {
+        return code;
+    }
+
+    // 5 characters, "00000" on success
+    const char* sqlState() const {
+        return state;
+    }
+
+    // update conflict, deadlock or lock timeout, as Transaction::isConflict()
+    bool isConflict() const {
+        return conflict;
+    }
+
+    // status of the calling thread, cleared; its IStatus is allocated once per thread
+    static CheckStatusWrapper* status();
+private:
+    bool failed = false;
+    bool conflict = false;
+    ISC_STATUS code = 0;
+    char state[FB_SQLSTATE_SIZE] = "00000";
+};
+
+#endif /* CALLRESULT_H */
@@ -0,0 +1,72 @@
+/* 
+ * File:   ColumnBlock.h
+ * Created on 17 ottobre 2026
+ */
+
+#ifndef COLUMNBLOCK_H
+#define COLUMNBLOCK_H
+
+#include <cstdint>
+#include <vector>
+
+// Block of rows stored by column, filled by Statement::fetchBlock().
+// Integer types are widened to int64_t, keeping the NUMERIC/DECIMAL scale of
+// the column, date and time types become microseconds (see DATETIME),
+// floating point goes to double, text goes into a character arena addressed
+// by offsets and any other type is kept as raw bytes in the same way.
+// Null values read as 0 or as empty strings.
+class ColumnBlock {
+public:
+    enum class ColumnType {
+        INTEGER,
+        // integers: microseconds from 1970-01-01 in UTC, from midnight for TIME
+        DATETIME,
+        DOUBLE,
+        STRING,
+        BINARY
+    };
+
+    class Column {
+    public:
+        ColumnType type = ColumnType::BINARY;
+        int scale = 0; // integers are value * 10^scale
+        std::vector<int64_t> integers;
+        std::vector<double> doubles;
+        std::vector<uint64_t> nulls; // bitmap, bit set for null values
+        std::vector<uint32_t> offsets; // rows + 1 offsets into chars
+        std::vector<char> chars;
+
+        bool isNull(size_t row) const {
+            return (nulls[row >> 6] >> (row & 63)) & 1;
+        }
+
+        const char* stringData(size_t row) const {
+            return chars.data() + offsets[row];
+        }
+
+        unsigned stringLength(size_t row) const {
+            return offsets[row + 1] - offsets[row];
+        }
+    };
+
+    size_t size() const {
+        return rows;
+    }
+
+    unsigned columnCount() const {
+        return columns.size();
+    }
+
+    const Column& column(unsigned idx) const {
+        return columns[idx];
+    }
+private:
+    friend class Statement;
+
+    std::vector<Column> columns;
+    std::vector<unsigned char> rowBuffer; // fetched messages
+    size_t rows = 0;
+};
+
+#endif /* COLUMNBLOCK_H */
+
@@ -0,0 +1,208 @@
+/*
+ * File:   DateTime.h
+ * Created on 17 ottobre 2026
+ */
+
+#ifndef DATETIME_H
+#define DATETIME_H
+
+#include <charconv> // to_chars
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "fb-wrapper.h"
+
+// Arithmetic conversions of the Firebird date and time types, without
+// struct tm: ISC_DATE counts the days from 1858-11-17, ISC_TIME the 1/10000
+// of second from midnight; the time zone types hold a UTC value.
+class DateTime {
+public:
+    // C++17 stand-in for std::chrono::sys_time<std::chrono::microseconds>
+    typedef std::chrono::time_point<std::chrono::system_clock, std::chrono::microseconds> Timestamp;
+
+    static const ISC_DATE EPOCH_DATE = 40587; // 1970-01-01
+    static const int64_t MICROS_PER_DAY = 86400000000LL;
+    static const unsigned MICROS_PER_UNIT = 1000000 / ISC_TIME_SECONDS_PRECISION;
+    static const unsigned short UTC_ZONE = 65535; // time zone id of GMT/UTC
+
+    // lengths of the ISO 8601 forms, years 0 to 9999
+    static const size_t DATE_LENGTH = 10; // 2026-10-17
+    static const size_t TIME_LENGTH = 13; // 12:34:56.7890
+    static const size_t TIMESTAMP_LENGTH = DATE_LENGTH + 1 + TIME_LENGTH;
+
+    static int64_t epochMicros(ISC_DATE date) {
+        return ((int64_t) date - EPOCH_DATE) * MICROS_PER_DAY;
+    }
+
+    // from midnight
+    static int64_t micros(ISC_TIME time) {
+        return (int64_t) time * MICROS_PER_UNIT;
+    }
+
+    static int64_t epochMicros(const ISC_TIMESTAMP& ts) {
+        return epochMicros(ts.timestamp_date) + micros(ts.timestamp_time);
+    }
+
+    // below 100 microseconds truncated toward the past
+    static ISC_TIMESTAMP timestamp(int64_t epochMicros) {
+        int64_t days = epochMicros / MICROS_PER_DAY;
+        int64_t rest = epochMicros % MICROS_PER_DAY;
+        if (rest < 0) {
+            rest += MICROS_PER_DAY;
+            --days;
+        }
+        ISC_TIMESTAMP ts;
+        ts.timestamp_date = (ISC_DATE) (days + EPOCH_DATE);
+        ts.timestamp_time = (ISC_TIME) (rest / MICROS_PER_UNIT);
+        return ts;
+    }
+
+    static ISC_TIME time(int64_t microsFromMidnight) {
+        return (ISC_TIME) (microsFromMidnight / MICROS_PER_UNIT);
+    }
+
+    static Timestamp timePoint(int64_t epochMicros) {
+        return Timestamp(std::chrono::microseconds(epochMicros));
+    }
+
+    static int64_t epochMicros(Timestamp t) {
+        return t.time_since_epoch().count();
+    }
+
+    // civil_from_days, H. Hinnant
+    static void civil(ISC_DATE date, int64_t& year, unsigned& month, unsigned& day) {
+        int64_t z = (int64_t) date - EPOCH_DATE + 719468;
+        int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+        unsigned doe = (unsigned) (z - era * 146097);
+        unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        unsigned mp = (5 * doy + 2) / 153;
+
+        year = (int64_t) yoe + era * 400;
+        day = doy - (153 * mp + 2) / 5 + 1;
+        month = mp < 10 ? mp + 3 : mp - 9;
+        if (month <= 2)
+            ++year;
+    }
+
+    // days_from_civil, H. Hinnant
+    static ISC_DATE date(int64_t year, unsigned month, unsigned day) {
+        year -= month <= 2;
+        int64_t era = (year >= 0 ? year : year - 399) / 400;
+        unsigned yoe = (unsigned) (year - era * 400);
+        unsigned doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+        unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return (ISC_DATE) (era * 146097 + (int64_t) doe - 719468 + EPOCH_DATE);
+    }
+
+    // ISO 8601 writers, return the end of the text
+    static char* formatDate(char* out, ISC_DATE date) {
+        int64_t y;
+        unsigned m, d;
+        civil(date, y, m, d);
+
+        if (y >= 0 && y <= 9999) {
+            out = digits2(out, (unsigned) y / 100);
+            out = digits2(out, (unsigned) y % 100);
+        } else
+            out = std::to_chars(out, out + 12, y).ptr;
+        *out++ = '-';
+        out = digits2(out, m);
+        *out++ = '-';
+        return digits2(out, d);
+    }
+
+    static char* formatTime(char* out, ISC_TIME time) {
+        unsigned seconds = time / ISC_TIME_SECONDS_PRECISION;
+        unsigned fraction = time % ISC_TIME_SECONDS_PRECISION;
+
+        out = digits2(out, seconds / 3600);
+        *out++ = ':';
+        out = digits2(out, seconds / 60 % 60);
+        *out++ = ':';
+        out = digits2(out, seconds % 60);
+        *out++ = '.';
+        out = digits2(out, fraction / 100);
+        return digits2(out, fraction % 100);
+    }
+
+    static char* formatTimestamp(char* out, const ISC_TIMESTAMP& ts, char separator = 'T') {
+        out = formatDate(out, ts.timestamp_date);
+        *out++ = separator;
+        return formatTime(out, ts.timestamp_time);
+    }
+
+    static bool accepts(unsigned type) {
+        switch (type) {
+            case SQL_TYPE_DATE:
+            case SQL_TYPE_TIME:
+            case SQL_TIMESTAMP:
+            case SQL_TIME_TZ:
+            case SQL_TIMESTAMP_TZ:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // message value of one of the accepted types: from 1970-01-01, or from
+    // midnight for the TIME types
+    static int64_t micros(const unsigned char* value, unsigned type) {
+        switch (type) {
+            case SQL_TYPE_DATE:
+                return epochMicros(*((const ISC_DATE*) value));
+            case SQL_TYPE_TIME:
+                return micros(*((const ISC_TIME*) value));
+            case SQL_TIMESTAMP:
+                return epochMicros(*((const ISC_TIMESTAMP*) value));
+            case SQL_TIME_TZ:
+                return micros(((const ISC_TIME_TZ*) value)->utc_time);
+            default:
+                return epochMicros(((const ISC_TIMESTAMP_TZ*) value)->utc_timestamp);
+        }
+    }
+
+    // ISO 8601 of one of the accepted types, time zone types in UTC with a Z;
+    // at most TIMESTAMP_LENGTH + 1 characters for years 0 to 9999
+    static char* format(char* out, const unsigned char* value, unsigned type) {
+        switch (type) {
+            case SQL_TYPE_DATE:
+                return formatDate(out, *((const ISC_DATE*) value));
+            case SQL_TYPE_TIME:
+                return formatTime(out, *((const ISC_TIME*) value));
+            case SQL_TIMESTAMP:
+                return formatTimestamp(out, *((const ISC_TIMESTAMP*) value));
+            case SQL_TIME_TZ:
+                out = formatTime(out, ((const ISC_TIME_TZ*) value)->utc_time);
+                break;
+            default:
+                out = formatTimestamp(out, ((const ISC_TIMESTAMP_TZ*) value)->utc_timestamp);
+                break;
+        }
+        *out++ = 'Z';
+        return out;
+    }
+
+    // whole columns, e.g. the rows of a fetched block
+    static void epochMicros(const ISC_DATE* dates, size_t n, int64_t* out) {
+        for (size_t j = 0; j < n; ++j)
+            out[j] = epochMicros(dates[j]);
+    }
+
+    static void epochMicros(const ISC_TIMESTAMP* ts, size_t n, int64_t* out) {
+        for (size_t j = 0; j < n; ++j)
+            out[j] = epochMicros(ts[j]);
+    }
+private:
+    static char* digits2(char* out, unsigned v) {
+        static constexpr char pairs[] =
+                "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+                "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+                "8081828384858687888990919293949596979899";
+        out[0] = pairs[2 * v];
+        out[1] = pairs[2 * v + 1];
+        return out + 2;
+    }
+};
+
+#endif /* DATETIME_H */
@@ -0,0 +1,450 @@
+/*
+ * File:   Decimal.cpp
+ * Created on 17 ottobre 2026
+ */
+
+#include <algorithm> // min
+#include <charconv> // from_chars, to_chars
+#include <cstring> // memcpy, strlen
+#include <limits>
+#include <stdexcept>
+#include "Decimal.h"
+
+typedef Decimal::Int128 Int128;
+typedef unsigned __int128 UInt128;
+
+static const Int128 INT128_MAX_VALUE = (Int128) (~(UInt128) 0 >> 1);
+static const Int128 INT128_MIN_VALUE = -INT128_MAX_VALUE - 1;
+
+struct Powers {
+    Int128 value[Decimal::MAX_DIGITS + 1];
+
+    constexpr Powers() : value() {
+        value[0] = 1;
+        for (int j = 1; j <= Decimal::MAX_DIGITS; ++j)
+            value[j] = value[j - 1] * 10;
+    }
+};
+
+static constexpr Powers powers;
+
+static Int128 pow10(int n) {
+    return powers.value[n];
+}
+
+static Int128 multiply(Int128 a, Int128 b) {
+    Int128 ret;
+    if (__builtin_mul_overflow(a, b, &ret))
+        throw std::out_of_range("Decimal: overflow!");
+    return ret;
+}
+
+static Int128 add(Int128 a, Int128 b) {
+    Int128 ret;
+    if (__builtin_add_overflow(a, b, &ret))
+        throw std::out_of_range("Decimal: overflow!");
+    return ret;
+}
+
+static Int128 scaleUp(Int128 v, int digits) {
+    if (!v)
+        return 0;
+    if (digits > Decimal::MAX_DIGITS)
+        throw std::out_of_range("Decimal: overflow!");
+    return multiply(v, pow10(digits));
+}
+
+// division rounded half away from zero
+static Int128 scaleDown(Int128 v, int digits) {
+    if (digits > Decimal::MAX_DIGITS)
+        return 0;
+
+    const Int128 d = pow10(digits);
+    Int128 q = v / d;
+    Int128 r = v % d;
+    if (r < 0)
+        r = -r;
+    if (r >= d - r)
+        q += v < 0 ? -1 : 1;
+    return q;
+}
+
+static int countDigits(UInt128 v) {
+    int n = 1;
+    while (n <= Decimal::MAX_DIGITS && v >= (UInt128) pow10(n))
+        ++n;
+    return n;
+}
+
+/*********************************************************
+ * Decimal
+ */
+Decimal Decimal::parse(std::string_view text) {
+    size_t begin = 0, end = text.size();
+    while (begin < end && (text[begin] == ' ' || text[begin] == '\t'))
+        ++begin;
+    while (end > begin && (text[end - 1] == ' ' || text[end - 1] == '\t'))
+        --end;
+
+    const char* p = text.data() + begin;
+    const char* last = text.data() + end;
+
+    bool negative = false;
+    if (p < last && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+
+    Int128 value = 0;
+    int scale = 0;
+    int digits = 0;
+    bool point = false;
+    bool any = false;
+
+    for (; p < last; ++p) {
+        if (*p >= '0' && *p <= '9') {
+            if (value || *p != '0') {
+                if (++digits > MAX_DIGITS)
+                    throw std::out_of_range("Decimal: more than 38 digits!");
+            }
+            value = value * 10 + (*p - '0');
+            any = true;
+            if (point)
+                --scale;
+        } else if (*p == '.' && !point) {
+            point = true;
+        } else {
+            break;
+        }
+    }
+
+    if (!any)
+        throw std::invalid_argument("Decimal: invalid number " + std::string(text) + "!");
+
+    if (p < last && (*p == 'e' || *p == 'E')) {
+        ++p;
+        if (p < last && *p == '+')
+            ++p;
+        int exponent;
+        auto res = std::from_chars(p, last, exponent);
+        if (res.ec != std::errc())
+            throw std::invalid_argument("Decimal: invalid number " + std::string(text) + "!");
+        p = res.ptr;
+        scale += exponent;
+    }
+
+    if (p != last)
+        throw std::invalid_argument("Decimal: invalid number " + std::string(text) + "!");
+
+    return Decimal(negative ? -value : value, scale);
+}
+
+Decimal Decimal::rescale(int scale) const {
+    if (scale == scale_)
+        return *this;
+    if (scale < scale_)
+        return Decimal(scaleUp(value_, scale_ - scale), scale);
+    return Decimal(scaleDown(value_, scale - scale_), scale);
+}
+
+int64_t Decimal::toInt64() const {
+    Int128 v = scale_ >= 0 ? scaleUp(value_, scale_)
+            : (-scale_ > MAX_DIGITS ? 0 : value_ / pow10(-scale_));
+
+    if (v < std::numeric_limits<int64_t>::min() || v > std::numeric_limits<int64_t>::max())
+        throw std::out_of_range("Decimal: out of the 64 bit range!");
+    return (int64_t) v;
+}
+
+double Decimal::toDouble() const {
+    // both operands exact: the quotient is correctly rounded
+    const Int128 exact = Int128(1) << 53;
+    if (value_ > -exact && value_ < exact && scale_ <= 0 && scale_ >= -22) {
+        static const double tens[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+        return (double) (int64_t) value_ / tens[-scale_];
+    }
+
+    char buf[MAX_LENGTH + 8];
+    char* end = format(buf);
+    double ret = 0;
+    std::from_chars(buf, end, ret);
+    return ret;
+}
+
+std::string Decimal::toString() const {
+    char buf[MAX_LENGTH];
+    return std::string(buf, format(buf));
+}
+
+char* Decimal::format(char* out) const {
+    // digits are written backwards, 19 at a time with 64 bit divisions
+    char digits[MAX_DIGITS + 2];
+    char* p = digits + sizeof (digits);
+
+    UInt128 mag = value_ < 0 ? -(UInt128) value_ : (UInt128) value_;
+    const uint64_t chunk = 10000000000000000000ull;
+    while (mag >= chunk) {
+        uint64_t low = (uint64_t) (mag % chunk);
+        mag /= chunk;
+        for (int j = 0; j < 19; ++j) {
+            *--p = '0' + low % 10;
+            low /= 10;
+        }
+    }
+    uint64_t high = (uint64_t) mag;
+    do {
+        *--p = '0' + high % 10;
+        high /= 10;
+    } while (high);
+
+    const int n = digits + sizeof (digits) - p;
+
+    if (value_ < 0)
+        *out++ = '-';
+
+    if (scale_ >= 0) {
+        std::memcpy(out, p, n);
+        out += n;
+        if (scale_ > 0 && value_) {
+            if (n + scale_ > MAX_DIGITS + 1) {
+                *out++ = 'E';
+                return std::to_chars(out, out + 12, scale_).ptr;
+            }
+            std::memset(out, '0', scale_);
+            out += scale_;
+        }
+        return out;
+    }
+
+    const int fraction = -scale_;
+    if (fraction > MAX_DIGITS + 1) {
+        std::memcpy(out, p, n);
+        out += n;
+        *out++ = 'E';
+        return std::to_chars(out, out + 12, scale_).ptr;
+    }
+
+    if (n > fraction) {
+        std::memcpy(out, p, n - fraction);
+        out += n - fraction;
+        *out++ = '.';
+        std::memcpy(out, p + n - fraction, fraction);
+        return out + fraction;
+    }
+
+    *out++ = '0';
+    *out++ = '.';
+    std::memset(out, '0', fraction - n);
+    out += fraction - n;
+    std::memcpy(out, p, n);
+    return out + n;
+}
+
+Decimal Decimal::operator-() const {
+    if (value_ == INT128_MIN_VALUE)
+        throw std::out_of_range("Decimal: overflow!");
+    return Decimal(-value_, scale_);
+}
+
+Decimal Decimal::operator+(const Decimal& other) const {
+    const int scale = std::min(scale_, other.scale_);
+    return Decimal(add(rescale(scale).value_, other.rescale(scale).value_), scale);
+}
+
+Decimal Decimal::operator-(const Decimal& other) const {
+    return *this + -other;
+}
+
+Decimal Decimal::operator*(const Decimal& other) const {
+    return Decimal(multiply(value_, other.value_), scale_ + other.scale_);
+}
+
+Decimal& Decimal::operator+=(const Decimal& other) {
+    // the common case of a sum over one column: no rescaling
+    if (scale_ == other.scale_)
+        value_ = add(value_, other.value_);
+    else
+        *this = *this + other;
+    return *this;
+}
+
+Decimal& Decimal::operator-=(const Decimal& other) {
+    return *this += -other;
+}
+
+int Decimal::compare(const Decimal& other) const {
+    if (scale_ == other.scale_)
+        return value_ < other.value_ ? -1 : value_ > other.value_;
+
+    // different signs need no rescaling, which could overflow
+    const int sign = value_ < 0 ? -1 : value_ > 0;
+    const int otherSign = other.value_ < 0 ? -1 : other.value_ > 0;
+    if (sign != otherSign)
+        return sign < otherSign ? -1 : 1;
+
+    try {
+        const int scale = std::min(scale_, other.scale_);
+        Int128 a = rescale(scale).value_;
+        Int128 b = other.rescale(scale).value_;
+        return a < b ? -1 : a > b;
+    } catch (const std::out_of_range&) {
+        // the one that overflows has the larger magnitude
+        const bool thisLarger = scale_ > other.scale_;
+        return (thisLarger ? sign : -sign);
+    }
+}
+
+bool Decimal::operator==(const Decimal& other) const {
+    return compare(other) == 0;
+}
+
+bool Decimal::operator!=(const Decimal& other) const {
+    return compare(other) != 0;
+}
+
+bool Decimal::operator<(const Decimal& other) const {
+    return compare(other) < 0;
+}
+
+bool Decimal::operator>(const Decimal& other) const {
+    return compare(other) > 0;
+}
+
+bool Decimal::operator<=(const Decimal& other) const {
+    return compare(other) <= 0;
+}
+
+bool Decimal::operator>=(const Decimal& other) const {
+    return compare(other) >= 0;
+}
+
+Decimal Decimal::fromInt128(const FB_I128& v, int scale) {
+    Int128 value;
+    std::memcpy(&value, &v, sizeof (value));
+    return Decimal(value, scale);
+}
+
+void Decimal::toInt128(FB_I128& v, int scale) const {
+    Int128 value = rescale(scale).value_;
+    std::memcpy(&v, &value, sizeof (value));
+}
+
+/*********************************************************
+ * DECFLOAT
+ */
+namespace {
+
+    // status for the IUtil calls, one per thread
+    struct UtilStatus {
+        ThrowStatusWrapper wrapper{master->getStatus()};
+
+        ~UtilStatus() {
+            wrapper.dispose();
+        }
+    };
+
+    ThrowStatusWrapper* utilStatus() {
+        thread_local UtilStatus status;
+        return &status.wrapper;
+    }
+
+    IDecFloat16* decFloat16() {
+        static IDecFloat16* ret = master->getUtilInterface()->getDecFloat16(utilStatus());
+        return ret;
+    }
+
+    IDecFloat34* decFloat34() {
+        static IDecFloat34* ret = master->getUtilInterface()->getDecFloat34(utilStatus());
+        return ret;
+    }
+
+    template <unsigned DIGITS>
+    Decimal fromBcd(int sign, const unsigned char* bcd, int exponent) {
+        Int128 value = 0;
+        for (unsigned j = 0; j < DIGITS; ++j)
+            value = value * 10 + bcd[j];
+
+        // DECFLOAT keeps at most 34 digits: a positive exponent moves them
+        // into the integer part as long as they fit
+        if (exponent > 0 && value) {
+            value = scaleUp(value, exponent);
+            exponent = 0;
+        }
+        return Decimal(sign ? -value : value, exponent);
+    }
+
+    // at most DIGITS digits, dropping fraction digits with rounding
+    template <unsigned DIGITS>
+    int toBcd(const Decimal& d, unsigned char* bcd, int& exponent) {
+        Decimal v = d;
+        UInt128 mag = v.value() < 0 ? -(UInt128) v.value() : (UInt128) v.value();
+        int n = countDigits(mag);
+        while (n > (int) DIGITS) {
+            v = v.rescale(v.scale() + n - DIGITS);
+            mag = v.value() < 0 ? -(UInt128) v.value() : (UInt128) v.value();
+            n = countDigits(mag);
+        }
+
+        for (int j = DIGITS - 1; j >= 0; --j) {
+            bcd[j] = (unsigned char) (mag % 10);
+            mag /= 10;
+        }
+        exponent = v.scale();
+        return v.value() < 0 ? 1 : 0;
+    }
+
+    void checkFinite(int exponent) {
+        // the specials (infinities, NaN) come with an exponent out of the finite range
+        if (exponent > 6144 || exponent < -6176)
+            throw std::out_of_range("Decimal: DECFLOAT value not finite!");
+    }
+}
+
+Decimal Decimal::fromDecFloat(const FB_DEC16& v) {
+    int sign, exponent;
+    unsigned char bcd[16];
+    decFloat16()->toBcd(&v, &sign, bcd, &exponent);
+    checkFinite(exponent);
+    return fromBcd<16>(sign, bcd, exponent);
+}
+
+Decimal Decimal::fromDecFloat(const FB_DEC34& v) {
+    int sign, exponent;
+    unsigned char bcd[34];
+    decFloat34()->toBcd(&v, &sign, bcd, &exponent);
+    checkFinite(exponent);
+    return fromBcd<34>(sign, bcd, exponent);
+}
+
+void Decimal::toDecFloat(FB_DEC16& v) const {
+    int exponent;
+    unsigned char bcd[16];
+    int sign = toBcd<16>(*this, bcd, exponent);
+    decFloat16()->fromBcd(sign, bcd, exponent, &v);
+}
+
+void Decimal::toDecFloat(FB_DEC34& v) const {
+    int exponent;
+    unsigned char bcd[34];
+    int sign = toBcd<34>(*this, bcd, exponent);
+    decFloat34()->fromBcd(sign, bcd, exponent, &v);
+}
+
+std::string Decimal::decFloatString(const FB_DEC16& v) {
+    char buf[IDecFloat16::STRING_SIZE];
+    return std::string(buf, formatDecFloat(buf, v));
+}
+
+std::string Decimal::decFloatString(const FB_DEC34& v) {
+    char buf[IDecFloat34::STRING_SIZE];
+    return std::string(buf, formatDecFloat(buf, v));
+}
+
+char* Decimal::formatDecFloat(char* out, const FB_DEC16& v) {
+    decFloat16()->toString(utilStatus(), &v, IDecFloat16::STRING_SIZE, out);
+    return out + std::strlen(out);
+}
+
+char* Decimal::formatDecFloat(char* out, const FB_DEC34& v) {
+    decFloat34()->toString(utilStatus(), &v, IDecFloat34::STRING_SIZE, out);
+    return out + std::strlen(out);
+}
@@ -0,0 +1,87 @@
+/*
+ * File:   Decimal.h
+ * Created on 17 ottobre 2026
+ */
+
+#ifndef DECIMAL_H
+#define DECIMAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "fb-wrapper.h"
+
+// Exact fixed point number: value * 10^scale, with a 128 bit value and the
+// scale as in the Firebird metadata (-2 for NUMERIC(18,2)). Covers NUMERIC
+// and DECIMAL up to 38 digits, INT128 and the finite DECFLOAT values that fit.
+// Arithmetic runs on the scaled integers; overflows throw std::out_of_range.
+class Decimal {
+public:
+    typedef __int128 Int128;
+
+    static const int MAX_DIGITS = 38;
+    static const size_t MAX_LENGTH = 56; // format() output, sign and point included
+
+    Decimal() = default;
+
+    Decimal(Int128 value, int scale) : value_(value), scale_(scale) {
+    }
+
+    // "-123.45", "1.5E3"; surrounding blanks are ignored
+    static Decimal parse(std::string_view text);
+
+    Int128 value() const {
+        return value_;
+    }
+
+    int scale() const {
+        return scale_;
+    }
+
+    // same number with another scale, rounded half away from zero when digits are dropped
+    Decimal rescale(int scale) const;
+    // fraction truncated
+    int64_t toInt64() const;
+    double toDouble() const;
+    std::string toString() const;
+    // writes at most MAX_LENGTH characters, returns the end
+    char* format(char* out) const;
+
+    Decimal operator-() const;
+    Decimal operator+(const Decimal& other) const;
+    Decimal operator-(const Decimal& other) const;
+    Decimal operator*(const Decimal& other) const;
+    Decimal& operator+=(const Decimal& other);
+    Decimal& operator-=(const Decimal& other);
+
+    bool operator==(const Decimal& other) const;
+    bool operator!=(const Decimal& other) const;
+    bool operator<(const Decimal& other) const;
+    bool operator>(const Decimal& other) const;
+    bool operator<=(const Decimal& other) const;
+    bool operator>=(const Decimal& other) const;
+
+    // message formats: INT128 is a native 128 bit integer, DECFLOAT goes
+    // through the BCD digits of IDecFloat16/34
+    static Decimal fromInt128(const FB_I128& v, int scale);
+    void toInt128(FB_I128& v, int scale) const;
+    static Decimal fromDecFloat(const FB_DEC16& v);
+    static Decimal fromDecFloat(const FB_DEC34& v);
+    void toDecFloat(FB_DEC16& v) const;
+    void toDecFloat(FB_DEC34& v) const;
+    // text form of any DECFLOAT value, infinities and huge exponents included
+    static std::string decFloatString(const FB_DEC16& v);
+    static std::string decFloatString(const FB_DEC34& v);
+    // the same written in place, out has room for IDecFloat16/34::STRING_SIZE
+    // bytes; returns the end of the text
+    static char* formatDecFloat(char* out, const FB_DEC16& v);
+    static char* formatDecFloat(char* out, const FB_DEC34& v);
+private:
+    int compare(const Decimal& other) const;
+
+    Int128 value_ = 0;
+    int scale_ = 0;
+};
+
+#endif /* DECIMAL_H */
@@ -6,57 +6,232 @@
 #ifndef EVENTDISPATCHER_H
 #define EVENTDISPATCHER_H
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
-#include <list>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
+// Callbacks are kept in an immutable vector published with copy-on-write:
+// broadcast() runs on a snapshot without locks, so callbacks may be added or
+// removed from other threads or from a callback itself. A callback removed
+// during a broadcast is not called afterwards by that broadcast; one removed
+// by another thread may still be running when removeCallBack() returns.
+// The price is on registration: addCallBack() and removeCallBack() copy the
+// whole vector, O(n) with two allocations (snapshot and buffer), against the
+// O(1) list node of a std::list. Fine for the few callbacks an attachment or
+// a transaction holds, not for hundreds of subscribers changing often.
 template <typename... Args>
 class EventDispatcher {
 public:
     typedef std::function<void(Args...) > CallBackFunction;
 
+    // generation tagged: a stale or already removed id is ignored
     class CBID {
     public:
-        CBID() : valid(false) {
+        CBID() = default;
+
+        explicit operator bool() const {
+            return id != 0;
         }
     private:
         friend class EventDispatcher<Args...>;
 
-        CBID(typename std::list<CallBackFunction>::iterator i)
-        : iter(i), valid(true) {
+        explicit CBID(uint64_t id) : id(id) {
         }
 
-        typename std::list<CallBackFunction>::iterator iter;
-        bool valid;
+        uint64_t id = 0;
     };
 
-    // register to be notified
-    CBID addCallBack(CallBackFunction cb) {
-        if (cb) {
-            cbs.push_back(cb);
-            return CBID(--cbs.end());
-        }
-        return CBID();
+    EventDispatcher() : slots(std::make_shared<const Slots>()) {
     }
 
-    // unregister to be notified
+    EventDispatcher(const EventDispatcher&) = delete;
+    EventDispatcher& operator=(const EventDispatcher&) = delete;
+
+    // register to be notified; callables up to three pointers are stored inline
+    template <typename F>
+    CBID addCallBack(F&& cb) {
+        if (isEmpty(cb))
+            return CBID();
+
+        std::lock_guard<std::mutex> lock(writer);
+        std::shared_ptr<const Slots> current = std::atomic_load(&slots);
+
+        auto next = std::make_shared<Slots>();
+        next->reserve(current->size() + 1);
+        for (const Slot &s : *current)
+            next->push_back(s);
+        next->push_back(Slot{++lastId, Callable(std::forward<F>(cb))});
+        publish(std::move(next));
 
+        return CBID(lastId);
+    }
+
+    // unregister to be notified
     void removeCallBack(CBID &id) {
-        if (id.valid) {
-            cbs.erase(id.iter);
+        if (!id.id)
+            return;
+
+        std::lock_guard<std::mutex> lock(writer);
+        std::shared_ptr<const Slots> current = std::atomic_load(&slots);
+
+        if (find(*current, id.id)) {
+            auto next = std::make_shared<Slots>();
+            next->reserve(current->size() - 1);
+            for (const Slot &s : *current) {
+                if (s.id != id.id)
+                    next->push_back(s);
+            }
+            publish(std::move(next));
         }
+        id.id = 0;
     }
 
     void broadcast(Args... args) {
-        for (auto &cb : cbs) {
-            cb(args...);
+        uint64_t seen = version.load(std::memory_order_acquire);
+        std::shared_ptr<const Slots> snapshot = std::atomic_load(&slots);
+        std::shared_ptr<const Slots> live;
+
+        for (const Slot &s : *snapshot) {
+            // the list changed since the snapshot: skip the removed callbacks
+            uint64_t v = version.load(std::memory_order_acquire);
+            if (v != seen) {
+                seen = v;
+                live = std::atomic_load(&slots);
+            }
+            if (live && !find(*live, s.id))
+                continue;
+
+            s.fn(args...);
         }
     }
 
 private:
-    std::list<CallBackFunction> cbs;
+    // type erased callable with small buffer storage
+    class Callable {
+    public:
+        template <typename F, typename D = std::decay_t<F> >
+        explicit Callable(F&& f) {
+            if constexpr (fitsInline<D>()) {
+                new (storage) D(std::forward<F>(f));
+                ops = &inlineOps<D>;
+            } else {
+                *reinterpret_cast<D**> (storage) = new D(std::forward<F>(f));
+                ops = &heapOps<D>;
+            }
+        }
+
+        Callable(const Callable& other) : ops(other.ops) {
+            ops->copy(storage, other.storage);
+        }
+
+        Callable(Callable&& other) noexcept : ops(other.ops) {
+            ops->move(storage, other.storage);
+        }
+
+        Callable& operator=(const Callable&) = delete;
+
+        ~Callable() {
+            ops->destroy(storage);
+        }
+
+        void operator()(Args... args) const {
+            ops->invoke(storage, args...);
+        }
+    private:
+        static const size_t CAPACITY = 3 * sizeof (void*);
+
+        struct Ops {
+            void (*invoke)(const void*, Args...);
+            void (*copy)(void*, const void*);
+            void (*move)(void*, void*);
+            void (*destroy)(void*);
+        };
+
+        template <typename D>
+        static constexpr bool fitsInline() {
+            return sizeof (D) <= CAPACITY && alignof (D) <= alignof (std::max_align_t)
+                    && std::is_nothrow_move_constructible<D>::value;
+        }
+
+        template <typename D>
+        static constexpr Ops inlineOps = {
+            [](const void* p, Args... args) {
+                (*static_cast<const D*> (p))(args...);
+            },
+            [](void* dst, const void* src) {
+                new (dst) D(*static_cast<const D*> (src));
+            },
+            [](void* dst, void* src) {
+                new (dst) D(std::move(*static_cast<D*> (src)));
+            },
+            [](void* p) {
+                static_cast<D*> (p)->~D();
+            }
+        };
+
+        template <typename D>
+        static constexpr Ops heapOps = {
+            [](const void* p, Args... args) {
+                (**static_cast<D * const*> (p))(args...);
+            },
+            [](void* dst, const void* src) {
+                *static_cast<D**> (dst) = new D(**static_cast<D * const*> (src));
+            },
+            [](void* dst, void* src) {
+                *static_cast<D**> (dst) = *static_cast<D**> (src);
+                *static_cast<D**> (src) = nullptr;
+            },
+            [](void* p) {
+                delete *static_cast<D**> (p);
+            }
+        };
+
+        alignas(std::max_align_t) unsigned char storage[CAPACITY];
+        const Ops* ops;
+    };
+
+    struct Slot {
+        uint64_t id;
+        Callable fn;
+    };
+
+    typedef std::vector<Slot> Slots; // sorted by id
+
+    template <typename F>
+    static bool isEmpty(const F&) {
+        return false;
+    }
+
+    static bool isEmpty(const CallBackFunction& cb) {
+        return !cb;
+    }
+
+    static bool find(const Slots& s, uint64_t id) {
+        auto it = std::lower_bound(s.begin(), s.end(), id, [](const Slot& slot, uint64_t id) {
+            return slot.id < id;
+        });
+        return it != s.end() && it->id == id;
+    }
+
+    void publish(std::shared_ptr<Slots> next) {
+        std::atomic_store(&slots, std::shared_ptr<const Slots>(std::move(next)));
+        version.fetch_add(1, std::memory_order_release);
+    }
+
+    std::shared_ptr<const Slots> slots;
+    std::atomic<uint64_t> version{0};
+    std::mutex writer;
+    uint64_t lastId = 0;
 };
 
 
 
 #endif /* EVENTDISPATCHER_H */
-
@@ -0,0 +1,265 @@
+/*
+ * File:   EventSubscription.cpp
+ * Created on 17 ottobre 2026
+ */
+
+#include <cstdio> // fprintf
+#include <stdexcept>
+#include "EventSubscription.h"
+
+static const unsigned char EPB_VERSION1 = 1;
+
+// event counts are little endian whatever the platform
+static uint32_t readCount(const std::vector<unsigned char>& epb, size_t offset) {
+    const unsigned char* p = epb.data() + offset;
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+// Called by Firebird on its own thread; lives as long as Firebird holds a
+// reference, and forwards nothing once detached from the subscription.
+class EventSubscription::Callback : public IEventCallbackImpl<EventSubscription::Callback, ThrowStatusWrapper> {
+public:
+    explicit Callback(EventSubscription* owner) : owner(owner) {
+    }
+
+    void addRef() override {
+        refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    int release() override {
+        if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+            return 0;
+        }
+        return 1;
+    }
+
+    void eventCallbackFunction(unsigned length, const unsigned char* events) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (owner)
+            owner->received(length, events);
+    }
+
+    // waits for a call in progress
+    void detach() {
+        std::lock_guard<std::mutex> lock(mutex);
+        owner = nullptr;
+    }
+private:
+    std::atomic<int> refs{1};
+    std::mutex mutex;
+    EventSubscription* owner;
+};
+
+EventSubscription::EventSubscription(Attachment& attachment) : attachment(attachment) {
+    status = new ThrowStatusWrapper(master->getStatus());
+
+    // events are cancelled before the attachment goes away
+    attachmentCallbackID = attachment.dispatcher.addCallBack([this](DBStateEvents evt) {
+        switch (evt) {
+            case DBStateEvents::ATTACHMENT_DISCONNECT:
+            case DBStateEvents::ATTACHMENT_DELETE:
+                stop();
+                break;
+
+            default:
+                break;
+        }
+    });
+}
+
+EventSubscription::~EventSubscription() {
+    attachment.dispatcher.removeCallBack(attachmentCallbackID);
+    stop();
+
+    if (status) {
+        status->dispose();
+        delete status;
+    }
+}
+
+void EventSubscription::setEvents(std::vector<std::string> names) {
+    for (const std::string& name : names) {
+        if (name.empty() || name.size() > 255)
+            throw std::invalid_argument("EventSubscription: invalid event name " + name + "!");
+    }
+    this->names = std::move(names);
+}
+
+void EventSubscription::setHandler(Handler handler) {
+    this->handler = std::move(handler);
+}
+
+void EventSubscription::setExecutor(AsyncExecutor* executor) {
+    this->executor = executor;
+}
+
+bool EventSubscription::isActive() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return thread.joinable() && !stopping;
+}
+
+void EventSubscription::start() {
+    if (isActive())
+        throw std::logic_error("EventSubscription: already started!");
+    if (names.empty() || !handler)
+        throw std::logic_error("EventSubscription: set events and handler before!");
+
+    // stopped from a handler: the thread is over but not joined yet
+    if (thread.joinable())
+        thread.join();
+    cancel();
+
+    attachment.connect();
+
+    request.assign(1, EPB_VERSION1);
+    countOffsets.clear();
+    for (const std::string& name : names) {
+        request.push_back((unsigned char) name.size());
+        request.insert(request.end(), name.begin(), name.end());
+        countOffsets.push_back(request.size());
+        request.insert(request.end(), 4, 0);
+    }
+
+    callback = new Callback(this);
+    pending = false;
+    stopping = false;
+    arm();
+    thread = std::thread(&EventSubscription::run, this);
+}
+
+void EventSubscription::stop() {
+    IEvents* events;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        events = events_;
+        events_ = nullptr;
+    }
+    cv.notify_one();
+
+    if (events) {
+        ThrowStatusWrapper st(master->getStatus());
+        try {
+            events->cancel(&st);
+        } catch (const FbException& e) {
+            char buf[256];
+            formatExceptionMessage(e, buf, 256);
+            fprintf(stderr, "%s\n", buf);
+        }
+        events->release();
+        st.dispose();
+    }
+
+    // a handler calling stop() leaves the join to start() or the destructor
+    if (thread.joinable() && thread.get_id() != std::this_thread::get_id()) {
+        thread.join();
+        cancel();
+    }
+}
+
+// after the thread is over: no more arm() with the callback
+void EventSubscription::cancel() {
+    if (callback) {
+        callback->detach();
+        callback->release();
+        callback = nullptr;
+    }
+}
+
+void EventSubscription::arm() {
+    IEvents* events = attachment.att_->queEvents(status, callback, request.size(), request.data());
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!stopping) {
+        if (events_)
+            events_->release();
+        events_ = events;
+        return;
+    }
+    lock.unlock();
+
+    // stop() came while arming
+    ThrowStatusWrapper st(master->getStatus());
+    try {
+        events->cancel(&st);
+    } catch (const FbException&) {
+    }
+    events->release();
+    st.dispose();
+}
+
+void EventSubscription::received(unsigned length, const unsigned char* events) {
+    // a cancelled request may be completed without counts
+    if (!length || !events)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        result.assign(events, events + length);
+        pending = true;
+    }
+    cv.notify_one();
+}
+
+void EventSubscription::run() {
+    // the first completion only reports the counts reached so far
+    bool baseline = true;
+    std::vector<unsigned char> counts;
+    std::vector<Event> posted;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this] {
+                return pending || stopping;
+            });
+            if (stopping)
+                break;
+            counts.swap(result);
+            pending = false;
+        }
+
+        if (counts.size() != request.size())
+            continue;
+
+        posted.clear();
+        for (size_t j = 0; j < names.size(); ++j) {
+            uint32_t before = readCount(request, countOffsets[j]);
+            uint32_t now = readCount(counts, countOffsets[j]);
+            if (!baseline && now != before)
+                posted.push_back(Event{names[j], now - before});
+        }
+        baseline = false;
+
+        // the counts received are the next request: what was posted while
+        // the handler runs completes it at once
+        request.swap(counts);
+        try {
+            arm();
+        } catch (const FbException& e) {
+            char buf[256];
+            formatExceptionMessage(e, buf, 256);
+            fprintf(stderr, "%s\n", buf);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+
+        if (posted.empty())
+            continue;
+
+        if (executor) {
+            Handler h = handler;
+            executor->post(this, [h, posted] {
+                h(posted);
+            });
+        } else {
+            try {
+                handler(posted);
+            } catch (const std::exception& e) {
+                fprintf(stderr, "EventSubscription: %s\n", e.what());
+            }
+        }
+    }
+}
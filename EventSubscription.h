@@ -0,0 +1,82 @@
+/*
+ * File:   EventSubscription.h
+ * Created on 17 ottobre 2026
+ */
+
+#ifndef EVENTSUBSCRIPTION_H
+#define EVENTSUBSCRIPTION_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "AsyncExecutor.h"
+#include "Attachment.h"
+
+// Database events raised with POST_EVENT, received through
+// IAttachment::queEvents. The Firebird callback only hands the new counts to
+// the subscription thread, which re-arms the request and delivers what was
+// posted meanwhile: events posted before a delivery completes are coalesced
+// into the next one. Handlers run on the subscription thread, or on an
+// executor in delivery order.
+class EventSubscription {
+public:
+    struct Event {
+        std::string name;
+        uint32_t count; // posted since the previous delivery
+    };
+
+    // only the events with a count
+    typedef std::function<void(const std::vector<Event>&)> Handler;
+
+    explicit EventSubscription(Attachment& attachment);
+    EventSubscription(const EventSubscription&) = delete;
+    EventSubscription& operator=(const EventSubscription&) = delete;
+    virtual ~EventSubscription();
+
+    // names up to 255 bytes, as given to POST_EVENT
+    void setEvents(std::vector<std::string> names);
+    void setHandler(Handler handler);
+    // deliver on the executor instead of the subscription thread
+    void setExecutor(AsyncExecutor* executor);
+
+    // connects the attachment; events posted from now on are delivered
+    void start();
+    // may be called from a handler
+    void stop();
+    bool isActive();
+private:
+    class Callback;
+
+    void arm();
+    void run();
+    void received(unsigned length, const unsigned char* events);
+    void cancel();
+
+    Attachment& attachment;
+    std::vector<std::string> names;
+    Handler handler;
+    AsyncExecutor* executor = nullptr;
+    ThrowStatusWrapper* status = nullptr;
+
+    // event parameter block: per name its length, the name and a 32 bit count
+    std::vector<unsigned char> request;
+    std::vector<size_t> countOffsets;
+    Callback* callback = nullptr;
+    IEvents* events_ = nullptr;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<unsigned char> result; // counts given by the last callback
+    bool pending = false;
+    bool stopping = false;
+    std::thread thread;
+
+    EventDispatcher<DBStateEvents>::CBID attachmentCallbackID;
+};
+
+#endif /* EVENTSUBSCRIPTION_H */
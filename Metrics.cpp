@@ -0,0 +1,289 @@
+/* 
+ * File:   Metrics.cpp
+ * Created on 17 ottobre 2026
+ */
+
+#include <algorithm> // min, max
+#include <cctype> // isalnum, toupper
+#include <cstdio> // snprintf
+#include <utility> // std::move
+#include "Metrics.h"
+
+/*********************************************************
+ * LatencyHistogram
+ */
+unsigned LatencyHistogram::bucketIndex(uint64_t ns) {
+    if (ns < SUB_BUCKETS)
+        return ns;
+
+    unsigned msb = 63 - __builtin_clzll(ns);
+    unsigned shift = msb - 3;
+    if (shift > MAX_SHIFT)
+        return BUCKETS - 1;
+
+    return (shift + 1) * SUB_BUCKETS + ((ns >> shift) & (SUB_BUCKETS - 1));
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(unsigned index) {
+    if (index < SUB_BUCKETS)
+        return index;
+
+    unsigned shift = index / SUB_BUCKETS - 1;
+    uint64_t low = uint64_t(SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+    return low + (uint64_t(1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t ns) {
+    counts[bucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(ns, std::memory_order_relaxed);
+
+    uint64_t v = min.load(std::memory_order_relaxed);
+    while (ns < v && !min.compare_exchange_weak(v, ns, std::memory_order_relaxed))
+        ;
+    v = max.load(std::memory_order_relaxed);
+    while (ns > v && !max.compare_exchange_weak(v, ns, std::memory_order_relaxed))
+        ;
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot ret;
+
+    ret.count = count.load(std::memory_order_relaxed);
+    ret.sum = sum.load(std::memory_order_relaxed);
+    ret.min = ret.count ? min.load(std::memory_order_relaxed) : 0;
+    ret.max = max.load(std::memory_order_relaxed);
+
+    for (unsigned j = 0; j < BUCKETS; ++j) {
+        uint64_t n = counts[j].load(std::memory_order_relaxed);
+        if (n)
+            ret.buckets.emplace_back(bucketUpperBound(j), n);
+    }
+    return ret;
+}
+
+uint64_t LatencyHistogram::Snapshot::percentile(double p) const {
+    uint64_t total = 0;
+    for (const auto &b : buckets)
+        total += b.second;
+
+    uint64_t rank = (uint64_t) (p / 100.0 * total + 0.5);
+    uint64_t seen = 0;
+    for (const auto &b : buckets) {
+        seen += b.second;
+        if (seen >= rank)
+            return b.first < max ? b.first : max;
+    }
+    return max;
+}
+
+/*********************************************************
+ * QueryMetrics
+ */
+QueryMetrics::QueryMetrics(std::string fingerprint, std::string sql)
+: fingerprint(std::move(fingerprint)), sql(std::move(sql)) {
+}
+
+/*********************************************************
+ * MetricsRegistry
+ */
+std::atomic<bool> MetricsRegistry::enabledFlag{false};
+
+MetricsRegistry& MetricsRegistry::instance() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+void MetricsRegistry::setEnabled(bool enabled) {
+    enabledFlag.store(enabled, std::memory_order_relaxed);
+}
+
+static bool isIdentifierChar(char c) {
+    return std::isalnum((unsigned char) c) || c == '_' || c == '$';
+}
+
+std::string MetricsRegistry::normalize(const std::string& sql) {
+    std::string ret;
+    ret.reserve(sql.size());
+
+    size_t i = 0;
+    const size_t n = sql.size();
+    while (i < n) {
+        char c = sql[i];
+
+        if (std::isspace((unsigned char) c) || (c == '-' && i + 1 < n && sql[i + 1] == '-')
+                || (c == '/' && i + 1 < n && sql[i + 1] == '*')) {
+            // blanks and comments collapse into one space
+            if (c == '-') {
+                while (i < n && sql[i] != '\n')
+                    ++i;
+            } else if (c == '/') {
+                i += 2;
+                while (i + 1 < n && !(sql[i] == '*' && sql[i + 1] == '/'))
+                    ++i;
+                i = i + 2 < n ? i + 2 : n;
+            } else
+                ++i;
+            if (!ret.empty() && ret.back() != ' ')
+                ret += ' ';
+        } else if (c == '\'') {
+            // string literal, '' is an escaped quote
+            ++i;
+            while (i < n) {
+                if (sql[i] == '\'') {
+                    if (i + 1 < n && sql[i + 1] == '\'')
+                        i += 2;
+                    else
+                        break;
+                } else
+                    ++i;
+            }
+            ++i;
+            ret += '?';
+        } else if (c == '"') {
+            // quoted identifier kept as is
+            size_t end = sql.find('"', i + 1);
+            end = end == std::string::npos ? n : end + 1;
+            ret.append(sql, i, end - i);
+            i = end;
+        } else if (c == ':' && i + 1 < n && isIdentifierChar(sql[i + 1])) {
+            ++i;
+            while (i < n && isIdentifierChar(sql[i]))
+                ++i;
+            ret += '?';
+        } else if (std::isdigit((unsigned char) c) && (ret.empty() || !isIdentifierChar(ret.back()))) {
+            while (i < n && (isIdentifierChar(sql[i]) || sql[i] == '.'))
+                ++i;
+            ret += '?';
+        } else {
+            ret += (char) std::toupper((unsigned char) c);
+            ++i;
+        }
+    }
+
+    if (!ret.empty() && ret.back() == ' ')
+        ret.pop_back();
+
+    return ret;
+}
+
+QueryMetrics* MetricsRegistry::statement(const std::string& sql) {
+    std::string normalized = normalize(sql);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<QueryMetrics>& ret = statements[normalized];
+
+    if (!ret) {
+        // FNV-1a, stable across runs
+        uint64_t hash = 14695981039346656037ull;
+        for (char c : normalized) {
+            hash ^= (unsigned char) c;
+            hash *= 1099511628211ull;
+        }
+        char buf[17];
+        snprintf(buf, sizeof (buf), "%016llx", (unsigned long long) hash);
+        ret.reset(new QueryMetrics(buf, normalized));
+    }
+    return ret.get();
+}
+
+MetricsSnapshot MetricsRegistry::snapshot() const {
+    MetricsSnapshot ret;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto &it : statements) {
+            const QueryMetrics& m = *it.second;
+            MetricsSnapshot::Statement s;
+            s.fingerprint = m.fingerprint;
+            s.sql = m.sql;
+            s.prepares = m.prepares.load(std::memory_order_relaxed);
+            s.executes = m.executes.load(std::memory_order_relaxed);
+            s.rowsFetched = m.rowsFetched.load(std::memory_order_relaxed);
+            s.bytesDecoded = m.bytesDecoded.load(std::memory_order_relaxed);
+            s.prepare = m.prepare.snapshot();
+            s.execute = m.execute.snapshot();
+            s.open = m.open.snapshot();
+            s.fetch = m.fetch.snapshot();
+            ret.statements.push_back(std::move(s));
+        }
+    }
+
+    ret.transactionStart = transactionStart.snapshot();
+    ret.commit = commit.snapshot();
+    ret.rollback = rollback.snapshot();
+    return ret;
+}
+
+/*********************************************************
+ * MetricsSnapshot
+ */
+// le boundaries of the exposition: 2^k ns, from about 1 us to 37 minutes
+static const unsigned MIN_EXPONENT = 10;
+static const unsigned MAX_EXPONENT = LatencyHistogram::MAX_SHIFT + 4;
+
+static void writeHistogram(std::string& out, const char* name, const std::string& labels,
+        const LatencyHistogram::Snapshot& h) {
+    // the log-linear sub-buckets folded into powers of two: a bucket ends
+    // below 2^k ns, each group of sub-buckets ends at a power of two
+    uint64_t counts[MAX_EXPONENT + 1] = {};
+    for (const auto &b : h.buckets) {
+        unsigned k = b.first ? 64 - __builtin_clzll(b.first) : 0;
+        counts[std::min(std::max(k, MIN_EXPONENT), MAX_EXPONENT)] += b.second;
+    }
+
+    // every boundary on every scrape, empty or not
+    char buf[64];
+    uint64_t cumulative = 0;
+    for (unsigned k = MIN_EXPONENT; k <= MAX_EXPONENT; ++k) {
+        cumulative += counts[k];
+        snprintf(buf, sizeof (buf), "%.9g", (double) (uint64_t(1) << k) / 1e9);
+        out += name;
+        out += "_bucket{" + labels + ",le=\"" + buf + "\"} " + std::to_string(cumulative) + "\n";
+    }
+    out += name;
+    out += "_bucket{" + labels + ",le=\"+Inf\"} " + std::to_string(h.count) + "\n";
+
+    snprintf(buf, sizeof (buf), "%.9g", h.sum / 1e9);
+    out += name;
+    out += "_sum{" + labels + "} " + buf + "\n";
+    out += name;
+    out += "_count{" + labels + "} " + std::to_string(h.count) + "\n";
+}
+
+static void writeCounter(std::string& out, const char* name, const std::string& labels, uint64_t value) {
+    out += name;
+    out += "{" + labels + "} " + std::to_string(value) + "\n";
+}
+
+std::string MetricsSnapshot::toPrometheus() const {
+    std::string out;
+
+    out += "# TYPE fbwrapper_statement_duration_seconds histogram\n";
+    for (const auto &s : statements) {
+        std::string labels = "fingerprint=\"" + s.fingerprint + "\",operation=";
+        writeHistogram(out, "fbwrapper_statement_duration_seconds", labels + "\"prepare\"", s.prepare);
+        writeHistogram(out, "fbwrapper_statement_duration_seconds", labels + "\"execute\"", s.execute);
+        writeHistogram(out, "fbwrapper_statement_duration_seconds", labels + "\"open\"", s.open);
+        writeHistogram(out, "fbwrapper_statement_duration_seconds", labels + "\"fetch\"", s.fetch);
+    }
+
+    const char* counters[] = {"fbwrapper_statement_prepares_total", "fbwrapper_statement_executes_total",
+        "fbwrapper_statement_rows_fetched_total", "fbwrapper_statement_bytes_decoded_total"};
+    for (unsigned j = 0; j < 4; ++j) {
+        out += "# TYPE ";
+        out += counters[j];
+        out += " counter\n";
+        for (const auto &s : statements) {
+            uint64_t values[] = {s.prepares, s.executes, s.rowsFetched, s.bytesDecoded};
+            writeCounter(out, counters[j], "fingerprint=\"" + s.fingerprint + "\"", values[j]);
+        }
+    }
+
+    out += "# TYPE fbwrapper_transaction_duration_seconds histogram\n";
+    writeHistogram(out, "fbwrapper_transaction_duration_seconds", "operation=\"start\"", transactionStart);
+    writeHistogram(out, "fbwrapper_transaction_duration_seconds", "operation=\"commit\"", commit);
+    writeHistogram(out, "fbwrapper_transaction_duration_seconds", "operation=\"rollback\"", rollback);
+
+    return out;
+}
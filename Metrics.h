@@ -0,0 +1,157 @@
+/* 
+ * File:   Metrics.h
+ * Created on 17 ottobre 2026
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Instrumentation is compiled in unless FB_WRAPPER_METRICS is defined to 0,
+// and records nothing until MetricsRegistry::setEnabled(true).
+#ifndef FB_WRAPPER_METRICS
+#define FB_WRAPPER_METRICS 1
+#endif
+
+// Log-linear latency histogram in nanoseconds: 8 buckets per power of two,
+// about 12% relative precision. record() is lock-free.
+class LatencyHistogram {
+public:
+    struct Snapshot {
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t min = 0;
+        uint64_t max = 0;
+        std::vector<std::pair<uint64_t, uint64_t> > buckets; // upper bound, count of the non empty buckets
+
+        uint64_t percentile(double p) const;
+    };
+
+    static const unsigned SUB_BUCKETS = 8;
+    static const unsigned MAX_SHIFT = 37; // values up to 2^40 ns
+    static const unsigned BUCKETS = (MAX_SHIFT + 2) * SUB_BUCKETS;
+
+    void record(uint64_t ns);
+    Snapshot snapshot() const;
+
+    static unsigned bucketIndex(uint64_t ns);
+    static uint64_t bucketUpperBound(unsigned index);
+private:
+    std::atomic<uint64_t> counts[BUCKETS] = {};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> min{UINT64_MAX};
+    std::atomic<uint64_t> max{0};
+};
+
+// counters and latencies of one normalized statement
+class QueryMetrics {
+public:
+    explicit QueryMetrics(std::string fingerprint, std::string sql);
+
+    const std::string fingerprint; // hash of the normalized sql
+    const std::string sql; // normalized sql
+
+    LatencyHistogram prepare;
+    LatencyHistogram execute;
+    LatencyHistogram open;
+    LatencyHistogram fetch;
+
+    std::atomic<uint64_t> prepares{0};
+    std::atomic<uint64_t> executes{0};
+    std::atomic<uint64_t> rowsFetched{0};
+    std::atomic<uint64_t> bytesDecoded{0};
+};
+
+struct MetricsSnapshot {
+    struct Statement {
+        std::string fingerprint;
+        std::string sql;
+        uint64_t prepares = 0;
+        uint64_t executes = 0;
+        uint64_t rowsFetched = 0;
+        uint64_t bytesDecoded = 0;
+        LatencyHistogram::Snapshot prepare;
+        LatencyHistogram::Snapshot execute;
+        LatencyHistogram::Snapshot open;
+        LatencyHistogram::Snapshot fetch;
+    };
+
+    std::vector<Statement> statements;
+    LatencyHistogram::Snapshot transactionStart;
+    LatencyHistogram::Snapshot commit;
+    LatencyHistogram::Snapshot rollback;
+
+    // Prometheus text exposition format, latencies in seconds; the histograms
+    // always have the same le boundaries, 2^k ns for k = 10 to 41
+    std::string toPrometheus() const;
+};
+
+class MetricsRegistry {
+public:
+    static MetricsRegistry& instance();
+
+    static bool enabled() {
+#if FB_WRAPPER_METRICS
+        return enabledFlag.load(std::memory_order_relaxed);
+#else
+        return false;
+#endif
+    }
+
+    static void setEnabled(bool enabled);
+
+    // sql with literals and parameters replaced by '?', blanks collapsed, upper case
+    static std::string normalize(const std::string& sql);
+
+    // metrics of the statement, created on first use; the pointer stays valid
+    QueryMetrics* statement(const std::string& sql);
+
+    LatencyHistogram transactionStart;
+    LatencyHistogram commit;
+    LatencyHistogram rollback;
+
+    MetricsSnapshot snapshot() const;
+private:
+    MetricsRegistry() = default;
+
+    static std::atomic<bool> enabledFlag;
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, std::unique_ptr<QueryMetrics> > statements; // by normalized sql
+};
+
+// records the lifetime of the scope into a histogram; no-op when metrics are off
+class ScopedTimer {
+public:
+#if FB_WRAPPER_METRICS
+    explicit ScopedTimer(LatencyHistogram* histogram)
+    : histogram(histogram && MetricsRegistry::enabled() ? histogram : nullptr) {
+        if (this->histogram)
+            start = std::chrono::steady_clock::now();
+    }
+
+    ~ScopedTimer() {
+        if (histogram)
+            histogram->record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+    }
+private:
+    LatencyHistogram* histogram;
+    std::chrono::steady_clock::time_point start;
+#else
+    explicit ScopedTimer(LatencyHistogram*) {
+    }
+#endif
+};
+
+#endif /* METRICS_H */
+
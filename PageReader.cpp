@@ -0,0 +1,30 @@
+/* 
+ * File:   PageReader.cpp
+ * Created on 17 ottobre 2026
+ */
+
+#include <climits>
+#include <stdexcept>
+#include "PageReader.h"
+
+PageReader::PageReader(Statement& statement, unsigned pageSize)
+: statement(statement), pageSize(pageSize) {
+    if (pageSize == 0)
+        throw std::invalid_argument("PageReader: invalid page size!");
+}
+
+unsigned PageReader::getPageSize() const {
+    return pageSize;
+}
+
+int PageReader::firstRow(unsigned page) const {
+    // fetchAbsolute() takes an int position
+    if ((uint64_t) page * pageSize >= INT_MAX)
+        throw std::out_of_range("PageReader: page out of range!");
+
+    return (int) (page * pageSize + 1);
+}
+
+size_t PageReader::read(unsigned page, ColumnBlock& block) {
+    return statement.fetchBlockAt(block, firstRow(page), pageSize);
+}
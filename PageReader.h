@@ -0,0 +1,50 @@
+/* 
+ * File:   PageReader.h
+ * Created on 17 ottobre 2026
+ */
+
+#ifndef PAGEREADER_H
+#define PAGEREADER_H
+
+#include <vector>
+#include "Statement.h"
+
+// Random access to fixed size pages of a scrollable cursor: each page is read
+// by positioning on its first row, without running the query again.
+// The statement must be opened after setScrollable(true).
+class PageReader {
+public:
+    PageReader(Statement& statement, unsigned pageSize);
+
+    unsigned getPageSize() const;
+
+    // pages count from 0; the rows read are fewer than the page size on the last page
+    size_t read(unsigned page, ColumnBlock& block);
+    template <typename Row>
+    size_t read(unsigned page, std::vector<Row>& rows);
+private:
+    int firstRow(unsigned page) const;
+
+    Statement& statement;
+    unsigned pageSize;
+};
+
+template <typename Row>
+size_t PageReader::read(unsigned page, std::vector<Row>& rows) {
+    rows.clear();
+
+    if (!statement.fetchAbsolute(firstRow(page)))
+        return 0;
+
+    rows.emplace_back();
+    statement.readRow(rows.back());
+
+    Row row;
+    while (rows.size() < pageSize && statement.fetchInto(row))
+        rows.push_back(std::move(row));
+
+    return rows.size();
+}
+
+#endif /* PAGEREADER_H */
+
@@ -0,0 +1,249 @@
+/* 
+ * File:   ParallelScan.cpp
+ * Created on 17 ottobre 2026
+ */
+
+#include <algorithm> // min
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility> // std::move
+#include "ParallelScan.h"
+
+ParallelScan::ParallelScan(AttachmentPool& pool) : pool(pool) {
+}
+
+void ParallelScan::setTable(std::string table) {
+    this->table = std::move(table);
+}
+
+void ParallelScan::setColumns(std::string columns) {
+    this->columns = std::move(columns);
+}
+
+void ParallelScan::setWhere(std::string condition) {
+    where = std::move(condition);
+}
+
+void ParallelScan::setPartitioning(Partitioning partitioning, std::string key) {
+    if (partitioning == Partitioning::KEY_RANGE && key.empty())
+        throw std::invalid_argument("ParallelScan: key required!");
+
+    this->partitioning = partitioning;
+    this->key = std::move(key);
+}
+
+void ParallelScan::setPartitions(unsigned partitions) {
+    if (partitions == 0)
+        throw std::invalid_argument("ParallelScan: invalid partitions!");
+
+    this->partitions = partitions;
+}
+
+std::vector<ParallelScan::KeyRange> ParallelScan::splitKeys(int64_t min, int64_t max, unsigned partitions) {
+    std::vector<KeyRange> ret;
+
+    if (max < min || !partitions)
+        return ret;
+
+    // up to 2^64 keys
+    unsigned __int128 keys = (unsigned __int128) (uint64_t(max) - uint64_t(min)) + 1;
+    unsigned n = keys < partitions ? (unsigned) keys : partitions;
+
+    // partition i starts at min + keys * i / n
+    int64_t low = min;
+    for (unsigned i = 1; i <= n; ++i) {
+        int64_t next = int64_t(uint64_t(min) + (uint64_t) (keys * i / n));
+        ret.push_back({low, i == n ? max : next - 1});
+        low = next;
+    }
+
+    return ret;
+}
+
+std::vector<ParallelScan::Range> ParallelScan::keyRanges(Transaction& transaction) {
+    Statement statement;
+    statement.setTransaction(&transaction);
+    statement.setSql("SELECT MIN(" + key + "), MAX(" + key + ") FROM " + table + whereClause());
+    statement.open();
+
+    std::vector<Range> ret;
+
+    if (statement.fetch() && !statement.field(0).isNull()) {
+        for (const KeyRange& r : splitKeys(statement.field(0).asInteger(), statement.field(1).asInteger(), partitions))
+            ret.push_back(key + " BETWEEN " + std::to_string(r.low) + " AND " + std::to_string(r.high));
+    }
+    statement.close();
+
+    return ret;
+}
+
+// DB_KEY bounds as SQL expressions, empty for no limit
+static std::string dbKeyCondition(const std::string& low, const std::string& high) {
+    std::string ret;
+
+    if (!low.empty())
+        ret = "RDB$DB_KEY >= " + low;
+    if (!high.empty())
+        ret += (ret.empty() ? "" : " AND ") + std::string("RDB$DB_KEY < ") + high;
+
+    return ret.empty() ? "1 = 1" : ret;
+}
+
+static std::string dbKeyLiteral(std::string_view dbKey) {
+    static const char hex[] = "0123456789ABCDEF";
+    std::string ret = "X'";
+
+    for (unsigned char c : dbKey) {
+        ret += hex[c >> 4];
+        ret += hex[c & 15];
+    }
+    return ret + "'";
+}
+
+std::vector<ParallelScan::Range> ParallelScan::dbKeyRanges(Transaction& transaction) {
+    Statement statement;
+    statement.setTransaction(&transaction);
+    statement.setSql("SELECT R.RDB$RELATION_ID, "
+            "(SELECT COUNT(*) FROM RDB$PAGES P WHERE P.RDB$RELATION_ID = R.RDB$RELATION_ID AND P.RDB$PAGE_TYPE = 4) "
+            "FROM RDB$RELATIONS R WHERE R.RDB$RELATION_NAME = ?");
+    statement.parameter(0).setText(table.c_str());
+    statement.open();
+
+    if (!statement.fetch())
+        throw std::invalid_argument("ParallelScan: unknown table " + table + "!");
+
+    int64_t relationId = statement.field(0).asInteger();
+    int64_t pages = statement.field(1).asInteger();
+    statement.close();
+
+    if (pages < partitions)
+        return recordRanges(transaction);
+
+    std::vector<Range> ret;
+    std::string dbKey = "MAKE_DBKEY(" + std::to_string(relationId) + ", 0, 0, ";
+    int64_t n = partitions;
+    for (int64_t i = 0; i < n; ++i) {
+        ret.push_back(dbKeyCondition(i ? dbKey + std::to_string(pages * i / n) + ")" : std::string(),
+                i + 1 < n ? dbKey + std::to_string(pages * (i + 1) / n) + ")" : std::string()));
+    }
+
+    return ret;
+}
+
+// Records come in DB_KEY order from a natural scan: the DB_KEYs found every
+// rows / partitions matching records bound the ranges. Costs a scan of the
+// table, only done when it is too small to split by pointer page.
+std::vector<ParallelScan::Range> ParallelScan::recordRanges(Transaction& transaction) {
+    Statement statement;
+    statement.setTransaction(&transaction);
+    statement.setSql("SELECT COUNT(*) FROM " + table + whereClause());
+    statement.open();
+    uint64_t rows = statement.fetch() ? statement.field(0).asInteger() : 0;
+    statement.close();
+
+    uint64_t n = rows < partitions ? rows : partitions;
+    std::vector<std::string> bounds;
+
+    if (n > 1) {
+        // the filter could otherwise pick an index, out of DB_KEY order
+        statement.setSql("SELECT RDB$DB_KEY FROM " + table + whereClause() + " PLAN (" + table + " NATURAL)");
+        statement.open();
+        for (uint64_t row = 0; bounds.size() + 1 < n && statement.fetch(); ++row) {
+            if (row == rows * (bounds.size() + 1) / n)
+                bounds.push_back(dbKeyLiteral(statement.field(0).asStringView()));
+        }
+        statement.close();
+    }
+
+    std::vector<Range> ret;
+    for (size_t i = 0; i <= bounds.size(); ++i)
+        ret.push_back(dbKeyCondition(i ? bounds[i - 1] : std::string(), i < bounds.size() ? bounds[i] : std::string()));
+
+    return ret;
+}
+
+std::string ParallelScan::whereClause() const {
+    return where.empty() ? std::string() : " WHERE (" + where + ")";
+}
+
+std::string ParallelScan::partitionSql(const Range& range) const {
+    std::string sql = "SELECT " + columns + " FROM " + table + " WHERE ";
+
+    if (!where.empty())
+        sql += "(" + where + ") AND ";
+
+    return sql + range;
+}
+
+void ParallelScan::scan(Transaction& transaction, unsigned partition, const Range& range, const Consumer& consumer) {
+    Statement statement;
+    statement.setTransaction(&transaction);
+    statement.setSql(partitionSql(range));
+    statement.open();
+    consumer(partition, statement);
+    statement.close();
+}
+
+void ParallelScan::run(const Consumer& consumer) {
+    if (table.empty())
+        throw std::logic_error("ParallelScan: set table before run!");
+
+    AttachmentPool::Lease lease = pool.acquire();
+
+    // this transaction holds the snapshot shared by all the partitions
+    Transaction snapshot;
+    snapshot.setOptions(Transaction::Options()
+            .setReadOnly()
+            .setIsolation(Transaction::Options::Isolation::SNAPSHOT));
+    snapshot.setAttachment(lease.get());
+    uint64_t snapshotNumber = snapshot.getSnapshotNumber();
+
+    std::vector<Range> ranges = partitioning == Partitioning::KEY_RANGE ?
+            keyRanges(snapshot) : dbKeyRanges(snapshot);
+
+    // partitions run here on the snapshot lease: the first one, or all of them
+    // when the pool has no other connection to give
+    size_t local = pool.getOptions().maxSize < 2 ? ranges.size() : std::min<size_t>(ranges.size(), 1);
+
+    std::mutex mutex;
+    std::exception_ptr error;
+    auto fail = [&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error)
+            error = std::current_exception();
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned i = local; i < ranges.size(); ++i) {
+        threads.emplace_back([&, i] {
+            try {
+                AttachmentPool::Lease partitionLease = pool.acquire();
+                Transaction transaction;
+                transaction.setOptions(Transaction::Options()
+                        .setReadOnly()
+                        .setAtSnapshotNumber(snapshotNumber));
+                transaction.setAttachment(partitionLease.get());
+                scan(transaction, i, ranges[i], consumer);
+                transaction.commit();
+            } catch (...) {
+                fail();
+            }
+        });
+    }
+
+    try {
+        for (unsigned i = 0; i < local; ++i)
+            scan(snapshot, i, ranges[i], consumer);
+    } catch (...) {
+        fail();
+    }
+
+    for (auto &thread : threads)
+        thread.join();
+
+    snapshot.commit();
+
+    if (error)
+        std::rethrow_exception(error);
+}
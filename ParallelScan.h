@@ -0,0 +1,70 @@
+/* 
+ * File:   ParallelScan.h
+ * Created on 17 ottobre 2026
+ */
+
+#ifndef PARALLELSCAN_H
+#define PARALLELSCAN_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "AttachmentPool.h"
+#include "Statement.h"
+
+// Reads a table in partitions, each on its own attachment and thread.
+// All the transactions share the snapshot of the first one (Firebird 4
+// isc_tpb_at_snapshot_number), so the partitions are consistent.
+// Partitions get attachments from the pool as they become free; with a pool
+// of a single connection they run one after the other on the caller thread.
+class ParallelScan {
+public:
+    enum class Partitioning {
+        KEY_RANGE, // integer key split in ranges between MIN and MAX
+        // RDB$DB_KEY ranges over the pointer pages of the table; a table with
+        // fewer pointer pages than partitions is split by counting its records
+        DB_KEY
+    };
+
+    struct KeyRange {
+        int64_t low;
+        int64_t high; // inclusive
+    };
+
+    // called on the partition thread with the statement already open
+    typedef std::function<void(unsigned partition, Statement& statement)> Consumer;
+
+    explicit ParallelScan(AttachmentPool& pool);
+    void setTable(std::string table);
+    void setColumns(std::string columns);
+    void setWhere(std::string condition);
+    void setPartitioning(Partitioning partitioning, std::string key = std::string());
+    void setPartitions(unsigned partitions);
+
+    void run(const Consumer& consumer);
+
+    // at most partitions ranges covering min to max, sizes differing by one key at most
+    static std::vector<KeyRange> splitKeys(int64_t min, int64_t max, unsigned partitions);
+private:
+    // key or DB_KEY condition of a partition
+    typedef std::string Range;
+
+    std::vector<Range> keyRanges(Transaction& transaction);
+    std::vector<Range> dbKeyRanges(Transaction& transaction);
+    std::vector<Range> recordRanges(Transaction& transaction);
+    std::string whereClause() const;
+    std::string partitionSql(const Range& range) const;
+    void scan(Transaction& transaction, unsigned partition, const Range& range, const Consumer& consumer);
+
+    AttachmentPool& pool;
+    std::string table;
+    std::string columns = "*";
+    std::string where;
+    Partitioning partitioning = Partitioning::DB_KEY;
+    std::string key;
+    unsigned partitions = 4;
+};
+
+#endif /* PARALLELSCAN_H */
+
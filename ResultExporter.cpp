@@ -0,0 +1,433 @@
+/* 
+ * File:   ResultExporter.cpp
+ * Created on 17 ottobre 2026
+ */
+
+#include <cerrno>
+#include <charconv> // to_chars
+#include <cmath> // isfinite
+#include <cstring> // memcpy
+#include <stdexcept>
+#include <system_error>
+#include <unistd.h> // write
+#include "ResultExporter.h"
+
+template <typename T>
+static T load(const unsigned char* p) {
+    T v;
+    std::memcpy(&v, p, sizeof (T));
+    return v;
+}
+
+static char* writeInteger(char* out, int64_t v, int scale) {
+    if (scale >= 0)
+        return std::to_chars(out, out + 24, v).ptr;
+
+    // NUMERIC/DECIMAL: v * 10^scale
+    uint64_t abs = v < 0 ? 0 - (uint64_t) v : (uint64_t) v;
+    uint64_t div = 1;
+    for (int j = 0; j < -scale; ++j)
+        div *= 10;
+
+    if (v < 0)
+        *out++ = '-';
+    out = std::to_chars(out, out + 20, abs / div).ptr;
+    *out++ = '.';
+
+    char frac[20];
+    char* end = std::to_chars(frac, frac + 20, abs % div).ptr;
+    for (long j = end - frac; j < -scale; ++j)
+        *out++ = '0';
+    std::memcpy(out, frac, end - frac);
+    return out + (end - frac);
+}
+
+static char* writeCsvText(char* out, const char* text, size_t length, char delimiter) {
+    bool quote = false;
+    for (size_t j = 0; j < length && !quote; ++j) {
+        char c = text[j];
+        quote = c == delimiter || c == '"' || c == '\n' || c == '\r';
+    }
+
+    if (!quote) {
+        std::memcpy(out, text, length);
+        return out + length;
+    }
+
+    *out++ = '"';
+    for (size_t j = 0; j < length; ++j) {
+        if (text[j] == '"')
+            *out++ = '"';
+        *out++ = text[j];
+    }
+    *out++ = '"';
+    return out;
+}
+
+static char* writeJsonText(char* out, const char* text, size_t length) {
+    static const char hex[] = "0123456789abcdef";
+
+    *out++ = '"';
+    size_t start = 0;
+    for (size_t j = 0; j < length; ++j) {
+        unsigned char c = text[j];
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+
+        std::memcpy(out, text + start, j - start);
+        out += j - start;
+        start = j + 1;
+
+        *out++ = '\\';
+        switch (c) {
+            case '"':
+            case '\\':
+                *out++ = c;
+                break;
+            case '\n':
+                *out++ = 'n';
+                break;
+            case '\r':
+                *out++ = 'r';
+                break;
+            case '\t':
+                *out++ = 't';
+                break;
+            default:
+                *out++ = 'u';
+                *out++ = '0';
+                *out++ = '0';
+                *out++ = hex[c >> 4];
+                *out++ = hex[c & 15];
+                break;
+        }
+    }
+    std::memcpy(out, text + start, length - start);
+    out += length - start;
+    *out++ = '"';
+    return out;
+}
+
+static size_t trimmedLength(const char* text, size_t length, bool trim) {
+    if (trim) {
+        while (length && text[length - 1] == ' ')
+            --length;
+    }
+    return length;
+}
+
+/*********************************************************
+ * Column formatters
+ */
+template <typename T>
+static char* formatInteger(char* out, const unsigned char* value, const ResultExporter::Column& c) {
+    return writeInteger(out, load<T>(value), c.scale);
+}
+
+static char* formatInt128(char* out, const unsigned char* value, const ResultExporter::Column& c) {
+    return Decimal::fromInt128(load<FB_I128>(value), c.scale).format(out);
+}
+
+template <typename T, bool JSON>
+static char* formatDecFloat(char* out, const unsigned char* value, const ResultExporter::Column&) {
+    char* end = Decimal::formatDecFloat(out, load<T>(value));
+    // infinities and NaN have no JSON number: Infinity, NaN, sNaN, signed or not
+    const char first = out[*out == '-' || *out == '+'];
+    if (JSON && (first == 'I' || first == 'N' || first == 's')) {
+        std::memcpy(out, "null", 4);
+        return out + 4;
+    }
+    return end;
+}
+
+template <typename T, bool JSON>
+static char* formatReal(char* out, const unsigned char* value, const ResultExporter::Column&) {
+    double v = load<T>(value);
+    if (JSON && !std::isfinite(v)) {
+        std::memcpy(out, "null", 4);
+        return out + 4;
+    }
+    return std::to_chars(out, out + 32, (T) v).ptr;
+}
+
+static char* formatBoolean(char* out, const unsigned char* value, const ResultExporter::Column&) {
+    if (*value) {
+        std::memcpy(out, "true", 4);
+        return out + 4;
+    }
+    std::memcpy(out, "false", 5);
+    return out + 5;
+}
+
+template <bool JSON>
+static char* formatDate(char* out, const unsigned char* value, const ResultExporter::Column&) {
+    if (JSON)
+        *out++ = '"';
+    out = DateTime::formatDate(out, load<ISC_DATE>(value));
+    if (JSON)
+        *out++ = '"';
+    return out;
+}
+
+template <bool JSON>
+static char* formatTime(char* out, const unsigned char* value, const ResultExporter::Column&) {
+    if (JSON)
+        *out++ = '"';
+    out = DateTime::formatTime(out, load<ISC_TIME>(value));
+    if (JSON)
+        *out++ = '"';
+    return out;
+}
+
+template <bool JSON>
+static char* formatTimestamp(char* out, const unsigned char* value, const ResultExporter::Column&) {
+    ISC_TIMESTAMP ts = load<ISC_TIMESTAMP>(value);
+    if (JSON)
+        *out++ = '"';
+    out = DateTime::formatTimestamp(out, ts);
+    if (JSON)
+        *out++ = '"';
+    return out;
+}
+
+// time zone types in UTC
+template <bool JSON>
+static char* formatTimeTz(char* out, const unsigned char* value, const ResultExporter::Column&) {
+    ISC_TIME_TZ t = load<ISC_TIME_TZ>(value);
+    if (JSON)
+        *out++ = '"';
+    out = DateTime::formatTime(out, t.utc_time);
+    *out++ = 'Z';
+    if (JSON)
+        *out++ = '"';
+    return out;
+}
+
+template <bool JSON>
+static char* formatTimestampTz(char* out, const unsigned char* value, const ResultExporter::Column&) {
+    ISC_TIMESTAMP_TZ ts = load<ISC_TIMESTAMP_TZ>(value);
+    if (JSON)
+        *out++ = '"';
+    out = DateTime::formatTimestamp(out, ts.utc_timestamp);
+    *out++ = 'Z';
+    if (JSON)
+        *out++ = '"';
+    return out;
+}
+
+template <bool JSON>
+static char* formatChar(char* out, const unsigned char* value, const ResultExporter::Column& c) {
+    const char* text = (const char*) value;
+    size_t length = trimmedLength(text, c.length, c.trimPadding);
+    return JSON ? writeJsonText(out, text, length) : writeCsvText(out, text, length, c.delimiter);
+}
+
+template <bool JSON>
+static char* formatVarchar(char* out, const unsigned char* value, const ResultExporter::Column& c) {
+    const char* text = (const char*) value + sizeof (short);
+    size_t length = load<unsigned short>(value);
+    return JSON ? writeJsonText(out, text, length) : writeCsvText(out, text, length, c.delimiter);
+}
+
+/*********************************************************
+ * ResultExporter
+ */
+ResultExporter::ResultExporter() {
+}
+
+ResultExporter::ResultExporter(const Options& options) : options(options) {
+}
+
+void ResultExporter::prepare(Statement& statement) {
+    if (!statement.resSet_)
+        throw std::logic_error("ResultExporter: open the statement before!");
+
+    const bool json = options.format == Format::JSONL;
+    columns.assign(statement.fieldsCount, Column());
+    maxRowLength = 3; // braces and new line
+
+    for (unsigned j = 0; j < statement.fieldsCount; ++j) {
+        const Statement::Field& f = statement.fields[j];
+        Column& c = columns[j];
+
+        c.offset = f.offset;
+        c.nullOffset = f.nullOffset;
+        c.length = f.length;
+        c.scale = statement.rowMeta->getScale(statement.status, j);
+        c.delimiter = options.delimiter;
+        c.trimPadding = options.trimPadding;
+
+        size_t length = 32;
+        switch (f.type) {
+            case SQL_SHORT:
+                c.format = formatInteger<ISC_SHORT>;
+                break;
+            case SQL_LONG:
+                c.format = formatInteger<ISC_LONG>;
+                break;
+            case SQL_INT64:
+                c.format = formatInteger<ISC_INT64>;
+                break;
+            case SQL_INT128:
+                c.format = formatInt128;
+                length = Decimal::MAX_LENGTH;
+                break;
+            case SQL_DEC16:
+                c.format = json ? formatDecFloat<FB_DEC16, true> : formatDecFloat<FB_DEC16, false>;
+                length = IDecFloat16::STRING_SIZE;
+                break;
+            case SQL_DEC34:
+                c.format = json ? formatDecFloat<FB_DEC34, true> : formatDecFloat<FB_DEC34, false>;
+                length = IDecFloat34::STRING_SIZE;
+                break;
+            case SQL_FLOAT:
+                c.format = json ? formatReal<float, true> : formatReal<float, false>;
+                break;
+            case SQL_DOUBLE:
+                c.format = json ? formatReal<double, true> : formatReal<double, false>;
+                break;
+            case SQL_BOOLEAN:
+                c.format = formatBoolean;
+                break;
+            case SQL_TYPE_DATE:
+                c.format = json ? formatDate<true> : formatDate<false>;
+                break;
+            case SQL_TYPE_TIME:
+                c.format = json ? formatTime<true> : formatTime<false>;
+                break;
+            case SQL_TIMESTAMP:
+                c.format = json ? formatTimestamp<true> : formatTimestamp<false>;
+                break;
+            case SQL_TIME_TZ:
+                c.format = json ? formatTimeTz<true> : formatTimeTz<false>;
+                break;
+            case SQL_TIMESTAMP_TZ:
+                c.format = json ? formatTimestampTz<true> : formatTimestampTz<false>;
+                break;
+            case SQL_TEXT:
+                c.format = json ? formatChar<true> : formatChar<false>;
+                length = (json ? 6 : 2) * (size_t) f.length + 2;
+                break;
+            case SQL_VARYING:
+                c.format = json ? formatVarchar<true> : formatVarchar<false>;
+                length = (json ? 6 : 2) * (size_t) f.length + 2;
+                break;
+            default:
+                throw std::invalid_argument("ResultExporter: unsupported data type for column "
+                    + std::to_string(j) + "!");
+        }
+
+        if (json) {
+            const char* name = statement.outMeta->getAlias(statement.status, j);
+            if (!name || !*name)
+                name = statement.outMeta->getField(statement.status, j);
+
+            std::string key(6 * strlen(name) + 2, '\0');
+            key.resize(writeJsonText(&key[0], name, strlen(name)) - &key[0]);
+            c.prefix = (j ? "," : "{") + key + ":";
+        }
+
+        maxRowLength += c.prefix.size() + std::max(length, options.nullValue.size() + 4) + 1;
+    }
+
+    if (buffer.size() < std::max(options.bufferSize, maxRowLength))
+        buffer.resize(std::max(options.bufferSize, maxRowLength));
+    used = 0;
+}
+
+void ResultExporter::writeHeader(Statement& statement) {
+    for (unsigned j = 0; j < statement.fieldsCount; ++j) {
+        const char* name = statement.outMeta->getAlias(statement.status, j);
+        if (!name || !*name)
+            name = statement.outMeta->getField(statement.status, j);
+
+        size_t length = strlen(name);
+        if (buffer.size() - used < 2 * length + 4)
+            flush();
+        if (buffer.size() - used < 2 * length + 4)
+            buffer.resize(used + 2 * length + 4);
+
+        char* out = buffer.data() + used;
+        if (j)
+            *out++ = options.delimiter;
+        out = writeCsvText(out, name, length, options.delimiter);
+        used = out - buffer.data();
+    }
+    buffer[used++] = '\n';
+}
+
+void ResultExporter::writeRow(const unsigned char* row) {
+    if (buffer.size() - used < maxRowLength)
+        flush();
+
+    char* out = buffer.data() + used;
+    const bool json = options.format == Format::JSONL;
+
+    for (size_t j = 0; j < columns.size(); ++j) {
+        const Column& c = columns[j];
+
+        if (json) {
+            std::memcpy(out, c.prefix.data(), c.prefix.size());
+            out += c.prefix.size();
+        } else if (j)
+            *out++ = options.delimiter;
+
+        if (load<short>(row + c.nullOffset)) {
+            if (json) {
+                std::memcpy(out, "null", 4);
+                out += 4;
+            } else {
+                std::memcpy(out, options.nullValue.data(), options.nullValue.size());
+                out += options.nullValue.size();
+            }
+        } else
+            out = c.format(out, row + c.offset, c);
+    }
+
+    if (json)
+        *out++ = columns.empty() ? '{' : '}';
+    if (json && columns.empty())
+        *out++ = '}';
+    *out++ = '\n';
+    used = out - buffer.data();
+}
+
+void ResultExporter::flush() {
+    if (used) {
+        (*sink)(buffer.data(), used);
+        used = 0;
+    }
+}
+
+uint64_t ResultExporter::write(Statement& statement, const Sink& sink) {
+    this->sink = &sink;
+    prepare(statement);
+
+    if (options.header && options.format == Format::CSV)
+        writeHeader(statement);
+
+    uint64_t rows = 0;
+    while (statement.fetch()) {
+        writeRow(statement.fieldsValueBuffer);
+        ++rows;
+    }
+
+    flush();
+    this->sink = nullptr;
+    return rows;
+}
+
+uint64_t ResultExporter::write(Statement& statement, int fd) {
+    return write(statement, [fd](const char* data, size_t length) {
+        while (length) {
+            ssize_t n = ::write(fd, data, length);
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                throw std::system_error(errno, std::generic_category(), "ResultExporter: write");
+            }
+            data += n;
+            length -= n;
+        }
+    });
+}
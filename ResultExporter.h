@@ -0,0 +1,72 @@
+/* 
+ * File:   ResultExporter.h
+ * Created on 17 ottobre 2026
+ */
+
+#ifndef RESULTEXPORTER_H
+#define RESULTEXPORTER_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "Statement.h"
+
+// Writes an open cursor as CSV (RFC 4180) or JSON Lines. Values are formatted
+// straight from the fetched message by one formatter per column, chosen once,
+// into a large buffer handed to the output in big sequential writes.
+class ResultExporter {
+public:
+    enum class Format {
+        CSV, JSONL
+    };
+
+    struct Options {
+        Format format = Format::CSV;
+        char delimiter = ',';
+        bool header = true; // CSV: column names on the first line
+        bool trimPadding = true; // trailing blanks of CHAR columns
+        std::string nullValue; // CSV text of NULL, JSON writes null
+        size_t bufferSize = 1 << 20;
+    };
+
+    // receives the formatted output, data is valid during the call only
+    typedef std::function<void(const char* data, size_t length)> Sink;
+
+    ResultExporter();
+    explicit ResultExporter(const Options& options);
+
+    // fetch the cursor to the end, returns the rows written; the cursor is left open
+    uint64_t write(Statement& statement, int fd);
+    uint64_t write(Statement& statement, const Sink& sink);
+
+    // per column formatter, chosen from the output metadata
+    struct Column;
+    typedef char* (*Formatter)(char* out, const unsigned char* value, const Column& column);
+
+    struct Column {
+        Formatter format = nullptr;
+        unsigned offset = 0;
+        unsigned nullOffset = 0;
+        unsigned length = 0;
+        int scale = 0;
+        char delimiter = ',';
+        bool trimPadding = true;
+        std::string prefix; // JSON: "name":
+    };
+private:
+    void prepare(Statement& statement);
+    void writeHeader(Statement& statement);
+    void writeRow(const unsigned char* row);
+    void flush();
+
+    Options options;
+    std::vector<Column> columns;
+    size_t maxRowLength = 0;
+    std::vector<char> buffer;
+    size_t used = 0;
+    const Sink* sink = nullptr;
+};
+
+#endif /* RESULTEXPORTER_H */
+
@@ -0,0 +1,535 @@
+/* 
+ * File:   RowBinding.h
+ * Created on 17 ottobre 2026
+ */
+
+#ifndef ROWBINDING_H
+#define ROWBINDING_H
+
+#include <charconv> // to_chars
+#include <chrono>
+#include <cmath> // floor
+#include <cstdint>
+#include <cstring> // memcpy, memset
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include "DateTime.h"
+#include "Decimal.h"
+#include "fb-wrapper.h"
+
+// Decoding of one column value into a C++ type.
+// select() is called once when the row type is bound to the statement, with
+// the column type and scale, and gives the reader of that column type, or
+// null when the column does not bind to T: scaled NUMERIC/DECIMAL columns
+// only bind to Decimal. The reader runs for every row.
+template <typename T>
+struct ColumnReader;
+
+template <typename T>
+struct ColumnReaderBase {
+    typedef T (*Read)(const unsigned char* value, unsigned length, int scale);
+};
+
+template <typename T>
+struct IntegerColumnReader : ColumnReaderBase<T> {
+    typedef typename ColumnReaderBase<T>::Read Read;
+
+    static Read select(unsigned type, int scale) {
+        if (scale)
+            return nullptr;
+
+        switch (type) {
+            case SQL_SHORT:
+                return &read<ISC_SHORT>;
+            case SQL_LONG:
+                if constexpr (sizeof (T) >= sizeof (ISC_LONG))
+                    return &read<ISC_LONG>;
+                return nullptr;
+            case SQL_INT64:
+                if constexpr (sizeof (T) >= sizeof (ISC_INT64))
+                    return &read<ISC_INT64>;
+                return nullptr;
+            default:
+                return nullptr;
+        }
+    }
+
+    template <typename S>
+    static T read(const unsigned char* value, unsigned, int) {
+        return *((const S*) value);
+    }
+};
+
+template <> struct ColumnReader<int16_t> : IntegerColumnReader<int16_t> {};
+template <> struct ColumnReader<int32_t> : IntegerColumnReader<int32_t> {};
+template <> struct ColumnReader<int64_t> : IntegerColumnReader<int64_t> {};
+
+template <>
+struct ColumnReader<float> : ColumnReaderBase<float> {
+    static Read select(unsigned type, int) {
+        return type == SQL_FLOAT ? &read : nullptr;
+    }
+
+    static float read(const unsigned char* value, unsigned, int) {
+        return *((const float*) value);
+    }
+};
+
+template <>
+struct ColumnReader<double> : ColumnReaderBase<double> {
+    static Read select(unsigned type, int) {
+        switch (type) {
+            case SQL_FLOAT:
+                return &read<float>;
+            case SQL_DOUBLE:
+                return &read<double>;
+            default:
+                return nullptr;
+        }
+    }
+
+    template <typename S>
+    static double read(const unsigned char* value, unsigned, int) {
+        return *((const S*) value);
+    }
+};
+
+template <>
+struct ColumnReader<bool> : ColumnReaderBase<bool> {
+    static Read select(unsigned type, int) {
+        return type == SQL_BOOLEAN ? &read : nullptr;
+    }
+
+    static bool read(const unsigned char* value, unsigned, int) {
+        return *value != 0;
+    }
+};
+
+// points into the fetched row: valid until the next fetch
+template <>
+struct ColumnReader<std::string_view> : ColumnReaderBase<std::string_view> {
+    static Read select(unsigned type, int) {
+        switch (type) {
+            case SQL_TEXT:
+                return &readText;
+            case SQL_VARYING:
+                return &readVarying;
+            default:
+                return nullptr;
+        }
+    }
+
+    static std::string_view readText(const unsigned char* value, unsigned length, int) {
+        return std::string_view((const char*) value, length);
+    }
+
+    static std::string_view readVarying(const unsigned char* value, unsigned, int) {
+        return std::string_view((const char*) value + sizeof (short), *((const unsigned short*) value));
+    }
+};
+
+template <>
+struct ColumnReader<std::string> : ColumnReaderBase<std::string> {
+    typedef ColumnReader<std::string_view> View;
+
+    static Read select(unsigned type, int) {
+        switch (type) {
+            case SQL_TEXT:
+                return &read<View::readText>;
+            case SQL_VARYING:
+                return &read<View::readVarying>;
+            default:
+                return nullptr;
+        }
+    }
+
+    template <View::Read R>
+    static std::string read(const unsigned char* value, unsigned length, int scale) {
+        return std::string(R(value, length, scale));
+    }
+};
+
+// scaled integers and DECFLOAT, exact
+template <>
+struct ColumnReader<Decimal> : ColumnReaderBase<Decimal> {
+    static Read select(unsigned type, int) {
+        switch (type) {
+            case SQL_SHORT:
+                return &readInteger<ISC_SHORT>;
+            case SQL_LONG:
+                return &readInteger<ISC_LONG>;
+            case SQL_INT64:
+                return &readInteger<ISC_INT64>;
+            case SQL_INT128:
+                return &readInt128;
+            case SQL_DEC16:
+                return &readDecFloat<FB_DEC16>;
+            case SQL_DEC34:
+                return &readDecFloat<FB_DEC34>;
+            default:
+                return nullptr;
+        }
+    }
+
+    template <typename S>
+    static Decimal readInteger(const unsigned char* value, unsigned, int scale) {
+        return Decimal(*((const S*) value), scale);
+    }
+
+    static Decimal readInt128(const unsigned char* value, unsigned, int scale) {
+        return Decimal::fromInt128(*((const FB_I128*) value), scale);
+    }
+
+    template <typename D>
+    static Decimal readDecFloat(const unsigned char* value, unsigned, int) {
+        return Decimal::fromDecFloat(*((const D*) value));
+    }
+};
+
+// UTC for the time zone types, from midnight for TIME
+template <>
+struct ColumnReader<DateTime::Timestamp> : ColumnReaderBase<DateTime::Timestamp> {
+    static Read select(unsigned type, int) {
+        switch (type) {
+            case SQL_TYPE_DATE:
+                return &read<SQL_TYPE_DATE>;
+            case SQL_TYPE_TIME:
+                return &read<SQL_TYPE_TIME>;
+            case SQL_TIMESTAMP:
+                return &read<SQL_TIMESTAMP>;
+            case SQL_TIME_TZ:
+                return &read<SQL_TIME_TZ>;
+            case SQL_TIMESTAMP_TZ:
+                return &read<SQL_TIMESTAMP_TZ>;
+            default:
+                return nullptr;
+        }
+    }
+
+    // the switch of DateTime::micros() folds on the constant type
+    template <unsigned TYPE>
+    static DateTime::Timestamp read(const unsigned char* value, unsigned, int) {
+        return DateTime::timePoint(DateTime::micros(value, TYPE));
+    }
+};
+
+// column value of a row member: std::optional<T> reads T and takes null
+// values, any other member type throws on them
+template <typename T>
+struct ColumnNull {
+    typedef T Value;
+    static constexpr bool nullable = false;
+};
+
+template <typename T>
+struct ColumnNull<std::optional<T> > {
+    typedef T Value;
+    static constexpr bool nullable = true;
+};
+
+// Encoding of one C++ value into a parameter of the input message.
+// write() gets the value slot at its precomputed offset and the scale of the
+// parameter; the null flag is set by the caller as told by ParameterNull.
+template <typename T, typename = void>
+struct ParameterWriter;
+
+template <typename N, typename V>
+N narrowParameter(V v) {
+    if constexpr (std::is_floating_point<V>::value) {
+        // -min is a power of two, exact as floating point; NaN fails too
+        if (!(v >= (V) std::numeric_limits<N>::min() && v < -(V) std::numeric_limits<N>::min()))
+            throw std::out_of_range("Binding parameter: value out of range!");
+    } else {
+        if (v < std::numeric_limits<N>::min() || v > std::numeric_limits<N>::max())
+            throw std::out_of_range("Binding parameter: value out of range!");
+    }
+    return (N) v;
+}
+
+template <>
+struct ParameterWriter<std::string_view> {
+    static void write(unsigned char* value, unsigned type, unsigned length, int, std::string_view v) {
+        if (v.size() > length)
+            throw std::out_of_range("Binding parameter: text longer than " + std::to_string(length) + " bytes!");
+
+        switch (type) {
+            case SQL_TEXT:
+                std::memcpy(value, v.data(), v.size());
+                std::memset(value + v.size(), ' ', length - v.size());
+                break;
+            case SQL_VARYING:
+                *((unsigned short*) value) = (unsigned short) v.size();
+                std::memcpy(value + sizeof (short), v.data(), v.size());
+                break;
+            default:
+                throw std::invalid_argument("Binding parameter: invalid data type!");
+        }
+    }
+};
+
+template <>
+struct ParameterWriter<std::string> : ParameterWriter<std::string_view> {};
+template <>
+struct ParameterWriter<const char*> : ParameterWriter<std::string_view> {};
+template <>
+struct ParameterWriter<char*> : ParameterWriter<std::string_view> {};
+
+// scaled integers written as they are, DECFLOAT through its BCD digits
+template <>
+struct ParameterWriter<Decimal> {
+    static void write(unsigned char* value, unsigned type, unsigned length, int scale, const Decimal& v) {
+        switch (type) {
+            case SQL_SHORT:
+                *((ISC_SHORT*) value) = narrowParameter<ISC_SHORT>(v.rescale(scale).value());
+                break;
+            case SQL_LONG:
+                *((ISC_LONG*) value) = narrowParameter<ISC_LONG>(v.rescale(scale).value());
+                break;
+            case SQL_INT64:
+                *((ISC_INT64*) value) = narrowParameter<ISC_INT64>(v.rescale(scale).value());
+                break;
+            case SQL_INT128:
+                v.toInt128(*((FB_I128*) value), scale);
+                break;
+            case SQL_DEC16:
+                v.toDecFloat(*((FB_DEC16*) value));
+                break;
+            case SQL_DEC34:
+                v.toDecFloat(*((FB_DEC34*) value));
+                break;
+            case SQL_FLOAT:
+                *((float*) value) = v.toDouble();
+                break;
+            case SQL_DOUBLE:
+                *((double*) value) = v.toDouble();
+                break;
+            case SQL_TEXT:
+            case SQL_VARYING:
+                writeText(value, type, length, v);
+                break;
+            default:
+                throw std::invalid_argument("Binding parameter: invalid data type!");
+        }
+    }
+
+    static void writeText(unsigned char* value, unsigned type, unsigned length, const Decimal& v) {
+        char buf[Decimal::MAX_LENGTH];
+        ParameterWriter<std::string_view>::write(value, type, length, 0, std::string_view(buf, v.format(buf) - buf));
+    }
+};
+
+template <typename T>
+struct ParameterWriter<T, std::enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value> > {
+    static void write(unsigned char* value, unsigned type, unsigned length, int scale, T v) {
+        if constexpr (std::is_unsigned<T>::value && sizeof (T) >= sizeof (int64_t)) {
+            if (v > (T) std::numeric_limits<int64_t>::max())
+                throw std::out_of_range("Binding parameter: value out of range!");
+        }
+        const int64_t n = v;
+
+        if (scale) {
+            ParameterWriter<Decimal>::write(value, type, length, scale, Decimal(n, 0));
+            return;
+        }
+
+        switch (type) {
+            case SQL_SHORT:
+                *((ISC_SHORT*) value) = narrowParameter<ISC_SHORT>(n);
+                break;
+            case SQL_LONG:
+                *((ISC_LONG*) value) = narrowParameter<ISC_LONG>(n);
+                break;
+            case SQL_INT64:
+                *((ISC_INT64*) value) = n;
+                break;
+            case SQL_FLOAT:
+                *((float*) value) = n;
+                break;
+            case SQL_DOUBLE:
+                *((double*) value) = n;
+                break;
+            case SQL_INT128:
+            case SQL_DEC16:
+            case SQL_DEC34:
+                ParameterWriter<Decimal>::write(value, type, length, scale, Decimal(n, 0));
+                break;
+            default:
+                throw std::invalid_argument("Binding parameter: invalid data type!");
+        }
+    }
+};
+
+template <typename T>
+struct ParameterWriter<T, std::enable_if_t<std::is_floating_point<T>::value> > {
+    static void write(unsigned char* value, unsigned type, unsigned length, int scale, T v) {
+        switch (type) {
+            case SQL_FLOAT:
+                *((float*) value) = v;
+                break;
+            case SQL_DOUBLE:
+                *((double*) value) = v;
+                break;
+            case SQL_SHORT:
+            case SQL_LONG:
+            case SQL_INT64:
+                if (!scale) {
+                    ParameterWriter<int64_t>::write(value, type, length, 0,
+                            narrowParameter<int64_t>(std::floor(v + 0.5)));
+                    break;
+                }
+                // rounded from the shortest digits: 1.005 binds 1.01 to NUMERIC(9,2)
+                [[fallthrough]];
+            case SQL_INT128:
+            case SQL_DEC16:
+            case SQL_DEC34:
+                ParameterWriter<Decimal>::write(value, type, length, scale, decimal(v));
+                break;
+            default:
+                throw std::invalid_argument("Binding parameter: invalid data type!");
+        }
+    }
+
+    // shortest decimal form of the binary value
+    static Decimal decimal(T v) {
+        char buf[64];
+        return Decimal::parse(std::string_view(buf, std::to_chars(buf, buf + sizeof (buf), v).ptr - buf));
+    }
+};
+
+// any system_clock precision, truncated to the 1/10000 s of Firebird
+template <typename D>
+struct ParameterWriter<std::chrono::time_point<std::chrono::system_clock, D> > {
+    static void write(unsigned char* value, unsigned type, unsigned length, int,
+            std::chrono::time_point<std::chrono::system_clock, D> v) {
+        const int64_t micros = std::chrono::floor<std::chrono::microseconds>(v).time_since_epoch().count();
+        const ISC_TIMESTAMP ts = DateTime::timestamp(micros);
+
+        switch (type) {
+            case SQL_TYPE_DATE:
+                *((ISC_DATE*) value) = ts.timestamp_date;
+                break;
+            case SQL_TYPE_TIME:
+                *((ISC_TIME*) value) = ts.timestamp_time;
+                break;
+            case SQL_TIMESTAMP:
+                *((ISC_TIMESTAMP*) value) = ts;
+                break;
+            case SQL_TIME_TZ:
+                ((ISC_TIME_TZ*) value)->utc_time = ts.timestamp_time;
+                ((ISC_TIME_TZ*) value)->time_zone = DateTime::UTC_ZONE;
+                break;
+            case SQL_TIMESTAMP_TZ:
+                ((ISC_TIMESTAMP_TZ*) value)->utc_timestamp = ts;
+                ((ISC_TIMESTAMP_TZ*) value)->time_zone = DateTime::UTC_ZONE;
+                break;
+            case SQL_TEXT:
+            case SQL_VARYING: {
+                char buf[DateTime::TIMESTAMP_LENGTH + 16];
+                char* end = DateTime::formatTimestamp(buf, ts);
+                ParameterWriter<std::string_view>::write(value, type, length, 0, std::string_view(buf, end - buf));
+                break;
+            }
+            default:
+                throw std::invalid_argument("Binding parameter: invalid data type!");
+        }
+    }
+};
+
+template <>
+struct ParameterWriter<bool> {
+    static void write(unsigned char* value, unsigned type, unsigned, int, bool v) {
+        if (type != SQL_BOOLEAN)
+            throw std::invalid_argument("Binding parameter: invalid data type!");
+        *value = v ? 1 : 0;
+    }
+};
+
+// blob id, see Blob::create()
+template <>
+struct ParameterWriter<ISC_QUAD> {
+    static void write(unsigned char* value, unsigned type, unsigned, int, const ISC_QUAD& v) {
+        if (type != SQL_BLOB)
+            throw std::invalid_argument("Binding parameter: invalid data type!");
+        *((ISC_QUAD*) value) = v;
+    }
+};
+
+template <typename T>
+struct ParameterWriter<std::optional<T> > {
+    static void write(unsigned char* value, unsigned type, unsigned length, int scale, const std::optional<T>& v) {
+        ParameterWriter<T>::write(value, type, length, scale, *v);
+    }
+};
+
+template <>
+struct ParameterWriter<std::nullopt_t> {
+    static void write(unsigned char*, unsigned, unsigned, int, std::nullopt_t) {
+    }
+};
+
+template <typename T>
+struct ParameterNull {
+    static bool test(const T&) {
+        return false;
+    }
+};
+
+template <typename T>
+struct ParameterNull<std::optional<T> > {
+    static bool test(const std::optional<T>& v) {
+        return !v;
+    }
+};
+
+template <>
+struct ParameterNull<std::nullopt_t> {
+    static bool test(std::nullopt_t) {
+        return true;
+    }
+};
+
+template <>
+struct ParameterNull<const char*> {
+    static bool test(const char* v) {
+        return v == nullptr;
+    }
+};
+
+template <>
+struct ParameterNull<char*> : ParameterNull<const char*> {};
+
+// Field descriptor of a user row type, columns are bound by position:
+//
+// template <> struct RowTraits<MyStruct> {
+//     static constexpr auto fields = std::make_tuple(&MyStruct::id, &MyStruct::name);
+// };
+template <typename Row>
+struct RowTraits;
+
+template <typename Row>
+struct RowAccess {
+    static constexpr size_t size = std::tuple_size<decltype(RowTraits<Row>::fields)>::value;
+
+    template <size_t I>
+    static auto& get(Row& row) {
+        return row.*std::get<I>(RowTraits<Row>::fields);
+    }
+};
+
+template <typename... T>
+struct RowAccess<std::tuple<T...> > {
+    static constexpr size_t size = sizeof...(T);
+
+    template <size_t I>
+    static auto& get(std::tuple<T...>& row) {
+        return std::get<I>(row);
+    }
+};
+
+#endif /* ROWBINDING_H */
+
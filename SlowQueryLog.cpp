@@ -0,0 +1,126 @@
+/* 
+ * File:   SlowQueryLog.cpp
+ * Created on 17 ottobre 2026
+ */
+
+#include <cstdio> // fprintf
+#include <ctime> // strftime
+#include "SlowQueryLog.h"
+
+std::atomic<int64_t> SlowQueryLog::thresholdNs{0};
+
+SlowQueryLog& SlowQueryLog::instance() {
+    static SlowQueryLog log;
+    return log;
+}
+
+SlowQueryLog::SlowQueryLog() : sink(stderrSink) {
+}
+
+SlowQueryLog::~SlowQueryLog() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+
+    if (worker.joinable())
+        worker.join();
+}
+
+void SlowQueryLog::setThreshold(std::chrono::nanoseconds threshold) {
+    thresholdNs.store(threshold.count() > 0 ? threshold.count() : 0, std::memory_order_relaxed);
+}
+
+std::chrono::nanoseconds SlowQueryLog::getThreshold() const {
+    return std::chrono::nanoseconds(thresholdNs.load(std::memory_order_relaxed));
+}
+
+void SlowQueryLog::setSink(Sink sink) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->sink = sink ? std::move(sink) : Sink(stderrSink);
+}
+
+void SlowQueryLog::setMaxPending(size_t maxPending) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->maxPending = maxPending;
+}
+
+uint64_t SlowQueryLog::getDropped() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return dropped;
+}
+
+void SlowQueryLog::stderrSink(const Record& record) {
+    char time[32];
+    std::time_t t = std::chrono::system_clock::to_time_t(record.time);
+    struct tm tm;
+    localtime_r(&t, &tm);
+    strftime(time, sizeof (time), "%Y-%m-%d %H:%M:%S", &tm);
+
+    std::string params;
+    for (size_t j = 0; j < record.parameters.size(); ++j) {
+        if (j)
+            params += ", ";
+        params += record.parameters[j];
+    }
+
+    fprintf(stderr, "%s slow query: %.3f ms, %llu rows\n  sql: %s\n  parameters: [%s]\n  plan: %s\n",
+            time, record.elapsed.count() / 1e6, (unsigned long long) record.rowsFetched,
+            record.sql.c_str(), params.c_str(),
+            record.detailedPlan.empty() ? record.plan.c_str() : record.detailedPlan.c_str());
+}
+
+void SlowQueryLog::log(Record record) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping)
+            return;
+
+        if (queue.size() >= maxPending) {
+            ++dropped;
+            return;
+        }
+        queue.push_back(std::move(record));
+
+        if (!worker.joinable())
+            worker = std::thread(&SlowQueryLog::run, this);
+    }
+    cv.notify_one();
+}
+
+void SlowQueryLog::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] {
+        return queue.empty() && !writing;
+    });
+}
+
+void SlowQueryLog::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for (;;) {
+        cv.wait(lock, [this] {
+            return stopping || !queue.empty();
+        });
+
+        if (queue.empty())
+            break; // stopping, everything written
+
+        Record record = std::move(queue.front());
+        queue.pop_front();
+        Sink s = sink;
+        writing = true;
+
+        lock.unlock();
+        try {
+            s(record);
+        } catch (const std::exception& e) {
+            fprintf(stderr, "SlowQueryLog: %s\n", e.what());
+        }
+        lock.lock();
+
+        writing = false;
+        idle.notify_all();
+    }
+}
@@ -0,0 +1,83 @@
+/* 
+ * File:   SlowQueryLog.h
+ * Created on 17 ottobre 2026
+ */
+
+#ifndef SLOWQUERYLOG_H
+#define SLOWQUERYLOG_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Log of the statements slower than a threshold: execute() is timed alone,
+// a cursor from open() to close(). Records are written by a background thread,
+// the statement only pays for the plan and the parameters of the slow ones.
+class SlowQueryLog {
+public:
+    struct Record {
+        std::chrono::system_clock::time_point time;
+        std::chrono::nanoseconds elapsed{0};
+        std::string sql;
+        std::vector<std::string> parameters; // as SQL literals
+        uint64_t rowsFetched = 0;
+        std::string plan;
+        std::string detailedPlan;
+    };
+
+    typedef std::function<void(const Record&)> Sink;
+
+    static SlowQueryLog& instance();
+
+    static bool enabled() {
+        return thresholdNs.load(std::memory_order_relaxed) > 0;
+    }
+
+    static bool isSlow(std::chrono::nanoseconds elapsed) {
+        int64_t t = thresholdNs.load(std::memory_order_relaxed);
+        return t > 0 && elapsed.count() >= t;
+    }
+
+    // zero disables the log
+    void setThreshold(std::chrono::nanoseconds threshold);
+    std::chrono::nanoseconds getThreshold() const;
+
+    // called on the log thread; the default sink writes to stderr
+    void setSink(Sink sink);
+    static void stderrSink(const Record& record);
+
+    // records beyond maxPending are dropped and counted
+    void setMaxPending(size_t maxPending);
+    uint64_t getDropped() const;
+
+    void log(Record record);
+    // waits until the queued records are written
+    void flush();
+private:
+    SlowQueryLog();
+    ~SlowQueryLog();
+    void run();
+
+    static std::atomic<int64_t> thresholdNs;
+
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    std::condition_variable idle;
+    std::deque<Record> queue;
+    Sink sink;
+    std::thread worker; // started by the first record
+    size_t maxPending = 1024;
+    uint64_t dropped = 0;
+    bool writing = false;
+    bool stopping = false;
+};
+
+#endif /* SLOWQUERYLOG_H */
+
@@ -3,8 +3,11 @@
  * Created on 27 luglio 2018
  */
 
-#include <cstring> // memcpy, memset
+#include <charconv> // from_chars
+#include <cstring> // memcpy, memset, strchr
 #include <cmath> // floor
+#include <cstdio> // snprintf
+#include <ctime> // strftime
 #include "Statement.h"
 
 Statement::Statement() {
@@ -14,27 +17,37 @@ Statement::Statement() {
 void Statement::setSql(std::string sql) {
     reset();
 
-    this->sql = std::move(sql);
-    initParametersByName();
+    originalSql = std::move(sql);
     isPrepared = false;
 }
 
 void Statement::setTransaction(Transaction* transaction) {
-    if (this->transaction) {
-        transaction->dispatcher.removeCallBack(transactionCallbackID);
-    }
-    
-    release();
+    if (this->transaction == transaction)
+        return;
+
+    if (this->transaction)
+        this->transaction->dispatcher.removeCallBack(transactionCallbackID);
+
+    closeCursor();
+
+    // a prepared statement belongs to the attachment: keep it when the
+    // new transaction runs on the same one
+    if (isPrepared && transaction->attachment != attachment)
+        reset();
 
     this->transaction = transaction;
 
     transactionCallbackID = transaction->dispatcher.addCallBack([this](DBStateEvents evt) {
         switch (evt) {
             case DBStateEvents::TRANSACTION_DISCONNECT:
-                release();
+                closeCursor();
+                break;
+            case DBStateEvents::ATTACHMENT_DISCONNECT:
+            case DBStateEvents::ATTACHMENT_DELETE:
+                reset();
                 break;
             case DBStateEvents::TRANSACTION_DELETE:
-                release();
+                reset();
                 this->transaction = nullptr;
                 break;
                 
@@ -47,6 +60,7 @@ void Statement::setTransaction(Transaction* transaction) {
 
 Statement::~Statement() {
     reset();
+    releaseArena();
 
     if (stmt_) {
         stmt_->release();
@@ -60,7 +74,7 @@ Statement::~Statement() {
         transaction->dispatcher.removeCallBack(transactionCallbackID);
 }
 
-void Statement::release() {
+void Statement::closeCursor() {
     try {
         close();
     } catch (const FbException& e) {
@@ -73,37 +87,51 @@ void Statement::release() {
         formatExceptionMessage(e, buf, 256);
         fprintf(stderr, "%s\n", buf);
     }
-    if (stmt_) {
-        stmt_->release();
-        stmt_ = nullptr;
-    }
 }
 
 void Statement::reset() {
-    if (stmt_) {
-        stmt_->release();
-        stmt_ = nullptr;
-    }
+    closeCursor();
+    releaseBatch();
+
+    if (rowMeta && rowMeta != outMeta)
+        rowMeta->release();
+    rowMeta = nullptr;
+
+    // give the prepared handle back to the attachment cache
+    if (stmt_ && attachment) {
+        StatementCache::Entry entry;
+        entry.sql = std::move(sql);
+        entry.namedParameters = std::move(namedParameters);
+        entry.parametersCount = parametersCount;
+        entry.stmt = stmt_;
+        entry.inMeta = inMeta;
+        entry.outMeta = outMeta;
+        entry.metrics = metrics;
+        entry.planCaptured = planCaptured;
+        entry.plan = std::move(plan);
+        entry.detailedPlan = std::move(detailedPlan);
+        attachment->statementCache.checkin(originalSql, std::move(entry));
 
-    if (fields) {
-        delete [] fields;
-        fields = nullptr;
+        stmt_ = nullptr;
+        inMeta = nullptr;
+        outMeta = nullptr;
     }
+    attachment = nullptr;
+    metrics = nullptr;
+    planCaptured = false;
+    plan.clear();
+    detailedPlan.clear();
 
-    if (fieldsValueBuffer) {
-        delete [] fieldsValueBuffer;
-        fieldsValueBuffer = nullptr;
+    if (stmt_) {
+        stmt_->release();
+        stmt_ = nullptr;
     }
 
-    if (parametersValueBuffer) {
-        delete [] parametersValueBuffer;
-        parametersValueBuffer = nullptr;
-    }
-
-    if (resSet_) {
-        resSet_->release();
-        resSet_ = nullptr;
-    }
+    // buffers and descriptors live in the arena, kept for the next statement
+    fields = nullptr;
+    parameters = nullptr;
+    fieldsValueBuffer = nullptr;
+    parametersValueBuffer = nullptr;
 
     if (inMeta) {
         inMeta->release();
@@ -114,6 +142,16 @@ void Statement::reset() {
         outMeta->release();
         outMeta = nullptr;
     }
+
+    sql.clear();
+    namedFields.clear();
+    namedParameters.clear();
+    fieldsCount = 0;
+    parametersCount = 0;
+    parametersBufferLength = 0;
+    fieldsBufferLength = 0;
+    boundRow = nullptr;
+    isPrepared = false;
 }
 
 void Statement::checkTransaction() {
@@ -126,51 +164,77 @@ void Statement::checkTransaction() {
 void Statement::prepare() {
     //!! call checkTransaction before prepare()
     if (!isPrepared) {
-        stmt_ = transaction->attachment->att_
-                ->prepare(status,
-                transaction->tra_, 0, sql.c_str(), SQL_DIALECT_V6,
-                IStatement::PREPARE_PREFETCH_METADATA);
+        StatementCache::Entry entry;
+
+        if (transaction->attachment->statementCache.checkout(originalSql, entry)) {
+            sql = std::move(entry.sql);
+            namedParameters = std::move(entry.namedParameters);
+            parametersCount = entry.parametersCount;
+            stmt_ = entry.stmt;
+            inMeta = entry.inMeta;
+            outMeta = entry.outMeta;
+            metrics = entry.metrics;
+            planCaptured = entry.planCaptured;
+            plan = std::move(entry.plan);
+            detailedPlan = std::move(entry.detailedPlan);
+            if (!metrics && MetricsRegistry::enabled())
+                metrics = MetricsRegistry::instance().statement(originalSql);
+        } else {
+            sql = originalSql;
+            initParametersByName();
+
+            if (MetricsRegistry::enabled()) {
+                metrics = MetricsRegistry::instance().statement(originalSql);
+                metrics->prepares.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            ScopedTimer timer(metrics ? &metrics->prepare : nullptr);
+            stmt_ = transaction->attachment->att_
+                    ->prepare(status,
+                    transaction->tra_, 0, sql.c_str(), SQL_DIALECT_V6,
+                    IStatement::PREPARE_PREFETCH_METADATA);
+
+            outMeta = stmt_->getOutputMetadata(status);
+            if (parametersCount)
+                inMeta = stmt_->getInputMetadata(status);
+        }
+        attachment = transaction->attachment;
 
-        outMeta = stmt_->getOutputMetadata(status);
         fieldsCount = outMeta->getCount(status);
+        rowMeta = fieldsCount && !coercion.empty() ? coerceOutput() : outMeta;
+        if (parametersCount)
+            assert(parametersCount == inMeta->getCount(status));
 
-        if (fieldsCount) {
-            // allocate output buffer
-            unsigned l = outMeta->getMessageLength(status);
-            fieldsValueBuffer = new unsigned char[l];
+        allocateBuffers(fieldsCount ? rowMeta->getMessageLength(status) : 0,
+                parametersCount ? inMeta->getMessageLength(status) : 0);
 
-            fields = new Field[fieldsCount];
+        if (fieldsCount) {
             const char *fieldName;
             for (unsigned j = 0; j < fieldsCount; ++j) {
                 fields[j].stmt = this;
-                fields[j].type = outMeta->getType(status, j) & ~1;
-                fields[j].length = outMeta->getLength(status, j);
-                fields[j].offset = outMeta->getOffset(status, j);
-                fields[j].nullOffset = outMeta->getNullOffset(status, j);
+                fields[j].type = rowMeta->getType(status, j) & ~1;
+                fields[j].length = rowMeta->getLength(status, j);
+                fields[j].offset = rowMeta->getOffset(status, j);
+                fields[j].nullOffset = rowMeta->getNullOffset(status, j);
+                fields[j].scale = rowMeta->getScale(status, j);
 
                 fieldName = outMeta->getAlias(status, j);
 
                 if (fieldName)
-                    namedFields[fieldName] = j;
+                    namedFields[std::string_view(fieldName)] = j;
                 else
-                    namedFields[outMeta->getField(status, j)] = j;
+                    namedFields[std::string_view(outMeta->getField(status, j))] = j;
             }
         }
 
         if (parametersCount) {
-            inMeta = stmt_->getInputMetadata(status);
-            inMeta->getCount(status);
-            assert(parametersCount == inMeta->getCount(status));
-            // allocate input buffer
-            unsigned l = inMeta->getMessageLength(status);
-            parametersValueBuffer = new unsigned char[l];
-            parameters = new Parameter[parametersCount];
             for (unsigned j = 0; j < parametersCount; ++j) {
                 parameters[j].stmt = this;
                 parameters[j].type = inMeta->getType(status, j) & ~1;
                 parameters[j].length = inMeta->getLength(status, j);
                 parameters[j].offset = inMeta->getOffset(status, j);
                 parameters[j].nullOffset = inMeta->getNullOffset(status, j);
+                parameters[j].scale = inMeta->getScale(status, j);
             }
         }
 
@@ -178,33 +242,211 @@ void Statement::prepare() {
     }
 }
 
+static size_t alignToCacheLine(size_t n) {
+    return (n + Statement::ARENA_ALIGNMENT - 1) & ~(Statement::ARENA_ALIGNMENT - 1);
+}
+
+void Statement::allocateBuffers(unsigned fieldsLength, unsigned parametersLength) {
+    static_assert(std::is_trivially_destructible<Field>::value && std::is_trivially_destructible<Parameter>::value,
+            "descriptors are dropped with the arena without destruction");
+
+    // output message, input message, then the descriptors, each on its own cache lines
+    const size_t fieldsDescriptors = alignToCacheLine(fieldsLength);
+    const size_t inputMessage = fieldsDescriptors + alignToCacheLine(fieldsCount * sizeof (Field));
+    const size_t parametersDescriptors = inputMessage + alignToCacheLine(parametersLength);
+    const size_t size = parametersDescriptors + alignToCacheLine(parametersCount * sizeof (Parameter));
+
+    if (size > arenaSize) {
+        releaseArena();
+        arena = (unsigned char*) memoryResource->allocate(size, ARENA_ALIGNMENT);
+        arenaSize = size;
+    }
+
+    fieldsBufferLength = fieldsLength;
+    parametersBufferLength = parametersLength;
+
+    if (fieldsCount) {
+        fieldsValueBuffer = arena;
+        fields = (Field*) (arena + fieldsDescriptors);
+        for (unsigned j = 0; j < fieldsCount; ++j)
+            new (fields + j) Field();
+    }
+
+    if (parametersCount) {
+        parametersValueBuffer = arena + inputMessage;
+        std::memset(parametersValueBuffer, 0, parametersLength);
+        parameters = (Parameter*) (arena + parametersDescriptors);
+        for (unsigned j = 0; j < parametersCount; ++j)
+            new (parameters + j) Parameter();
+    }
+}
+
+void Statement::releaseArena() {
+    if (arena) {
+        memoryResource->deallocate(arena, arenaSize, ARENA_ALIGNMENT);
+        arena = nullptr;
+        arenaSize = 0;
+    }
+}
+
+Statement::OutputCoercion& Statement::OutputCoercion::setColumn(unsigned index, unsigned type,
+        unsigned length, int scale) {
+    columns.push_back(Column{index, type & ~1u, length, scale});
+    return *this;
+}
+
+bool Statement::OutputCoercion::empty() const {
+    return !integersAsInt64 && !floatAsDouble && !charAsVarchar && columns.empty();
+}
+
+void Statement::setOutputCoercion(OutputCoercion coercion) {
+    // the buffers are laid out again on the next prepare
+    reset();
+    this->coercion = std::move(coercion);
+}
+
+// message length of the fixed size types, 0 for the others
+static unsigned typeLength(unsigned type) {
+    switch (type) {
+        case SQL_BOOLEAN:
+            return 1;
+        case SQL_SHORT:
+            return sizeof (ISC_SHORT);
+        case SQL_LONG:
+        case SQL_FLOAT:
+        case SQL_TYPE_DATE:
+        case SQL_TYPE_TIME:
+            return 4;
+        case SQL_INT64:
+        case SQL_DOUBLE:
+        case SQL_TIMESTAMP:
+        case SQL_BLOB:
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+IMessageMetadata* Statement::coerceOutput() {
+    IMetadataBuilder* builder = outMeta->getBuilder(status);
+
+    try {
+        for (unsigned j = 0; j < fieldsCount; ++j) {
+            unsigned type = outMeta->getType(status, j) & ~1;
+
+            if (coercion.integersAsInt64 && (type == SQL_SHORT || type == SQL_LONG)) {
+                builder->setType(status, j, SQL_INT64 | 1);
+                builder->setLength(status, j, sizeof (ISC_INT64));
+            } else if (coercion.floatAsDouble && type == SQL_FLOAT) {
+                builder->setType(status, j, SQL_DOUBLE | 1);
+                builder->setLength(status, j, sizeof (double));
+            } else if (coercion.charAsVarchar && type == SQL_TEXT) {
+                // same length: VARCHAR keeps its size prefix out of it
+                builder->setType(status, j, SQL_VARYING | 1);
+            }
+        }
+
+        for (const OutputCoercion::Column& c : coercion.columns) {
+            if (c.index >= fieldsCount)
+                throw std::invalid_argument("Statement: coerced column out of range!");
+
+            builder->setType(status, c.index, c.type | 1);
+            unsigned length = c.length ? c.length : typeLength(c.type);
+            if (length)
+                builder->setLength(status, c.index, length);
+            builder->setScale(status, c.index, c.scale);
+        }
+
+        IMessageMetadata* coerced = builder->getMetadata(status);
+        builder->release();
+        return coerced;
+    } catch (...) {
+        builder->release();
+        throw;
+    }
+}
+
+const unsigned char* Statement::getRowBuffer() const {
+    return fieldsValueBuffer;
+}
+
+unsigned Statement::getRowLength() const {
+    return fieldsBufferLength;
+}
+
+void Statement::setMemoryResource(std::pmr::memory_resource* resource) {
+    // unprepares: the handle goes back to the attachment cache and the parameter
+    // values are lost; the next prepare() takes it from the cache with buffers
+    // allocated from the new resource
+    reset();
+    releaseArena();
+    memoryResource = resource ? resource : std::pmr::get_default_resource();
+}
+
 void Statement::open() {
     checkTransaction();
 
     if (!isPrepared)
         prepare();
 
-    if (!stmt_)
-        stmt_ = transaction->attachment->att_
-            ->prepare(status,
-            transaction->tra_, 0, sql.c_str(), SQL_DIALECT_V6, 0);
+    cursorRows = 0;
+    cursorTimed = SlowQueryLog::enabled();
+    if (cursorTimed) {
+        cursorStart = std::chrono::steady_clock::now();
+        cursorParameters.assign(parametersValueBuffer, parametersValueBuffer + parametersBufferLength);
+    }
 
-    resSet_ = stmt_->openCursor(status, transaction->tra_, inMeta, parametersValueBuffer, NULL, 0);
+    ScopedTimer timer(metrics ? &metrics->open : nullptr);
+    countExecute();
+    resSet_ = stmt_->openCursor(status, transaction->tra_, inMeta, parametersValueBuffer,
+            rowMeta != outMeta ? rowMeta : NULL,
+            scrollable ? IStatement::CURSOR_TYPE_SCROLLABLE : 0);
 }
 
 void Statement::execute() {
+    executeWith(status);
+}
+
+CallResult Statement::tryExecute() {
+    CheckStatusWrapper* st = CallResult::status();
+    executeWith(st);
+    if (st->getState() & IStatus::STATE_ERRORS)
+        return CallResult(st->getErrors());
+    return CallResult();
+}
+
+template <typename StatusType>
+void Statement::executeWith(StatusType* st) {
     checkTransaction();
 
     if (!isPrepared)
         prepare();
 
-    if (!stmt_)
-        stmt_ = transaction->attachment->att_
-            ->prepare(status,
-            transaction->tra_, 0, sql.c_str(), SQL_DIALECT_V6, 0);
+    const bool slowLog = SlowQueryLog::enabled();
+    std::chrono::steady_clock::time_point start;
+    if (slowLog)
+        start = std::chrono::steady_clock::now();
 
-    stmt_->execute(status, transaction->tra_, inMeta, parametersValueBuffer, NULL, NULL);
+    {
+        ScopedTimer timer(metrics ? &metrics->execute : nullptr);
+        countExecute();
+        stmt_->execute(st, transaction->tra_, inMeta, parametersValueBuffer, NULL, NULL);
+    }
 
+    if (slowLog && !(st->getState() & IStatus::STATE_ERRORS))
+        checkSlowQuery(start, 0, parametersValueBuffer);
+}
+
+void Statement::countExecute() {
+    if (metrics && MetricsRegistry::enabled())
+        metrics->executes.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Statement::countRows(size_t rows) {
+    if (metrics && MetricsRegistry::enabled()) {
+        metrics->rowsFetched.fetch_add(rows, std::memory_order_relaxed);
+        metrics->bytesDecoded.fetch_add(rows * fieldsBufferLength, std::memory_order_relaxed);
+    }
 }
 
 uint64_t Statement::getAffectedRecords() {
@@ -214,8 +456,132 @@ uint64_t Statement::getAffectedRecords() {
         return 0;
 }
 
+const std::string& Statement::getPlan(bool detailed) {
+    checkTransaction();
+
+    if (!isPrepared)
+        prepare();
+
+    if (!planCaptured)
+        capturePlan();
+
+    return detailed ? detailedPlan : plan;
+}
+
+void Statement::capturePlan() {
+    const char* p = stmt_->getPlan(status, FB_FALSE);
+    plan = p ? p : "";
+    p = stmt_->getPlan(status, FB_TRUE);
+    detailedPlan = p ? p : "";
+    planCaptured = true;
+}
+
+template <typename T>
+static T load(const unsigned char* p) {
+    T v;
+    std::memcpy(&v, p, sizeof (T)); // the copied parameters are not aligned
+    return v;
+}
+
+static std::string quote(const char* text, size_t length) {
+    std::string ret = "'";
+    for (size_t j = 0; j < length; ++j) {
+        if (text[j] == '\'')
+            ret += '\'';
+        ret += text[j];
+    }
+    return ret + "'";
+}
+
+// parameter value as an SQL literal
+static std::string formatParameter(const unsigned char* buffer, const Statement::Parameter& p) {
+    if (load<short>(buffer + p.nullOffset))
+        return "NULL";
+
+    const unsigned char* v = buffer + p.offset;
+    char buf[64];
+
+    switch (p.type) {
+        case SQL_TEXT:
+            return quote((const char*) v, p.length);
+        case SQL_VARYING:
+            return quote((const char*) v + sizeof (short), load<unsigned short>(v));
+        case SQL_SHORT:
+            return Decimal(load<ISC_SHORT>(v), p.scale).toString();
+        case SQL_LONG:
+            return Decimal(load<ISC_LONG>(v), p.scale).toString();
+        case SQL_INT64:
+            return Decimal(load<ISC_INT64>(v), p.scale).toString();
+        case SQL_INT128:
+            return Decimal::fromInt128(load<FB_I128>(v), p.scale).toString();
+        case SQL_DEC16:
+            return Decimal::decFloatString(load<FB_DEC16>(v));
+        case SQL_DEC34:
+            return Decimal::decFloatString(load<FB_DEC34>(v));
+        case SQL_FLOAT:
+            snprintf(buf, sizeof (buf), "%.9g", load<float>(v));
+            return buf;
+        case SQL_DOUBLE:
+            snprintf(buf, sizeof (buf), "%.17g", load<double>(v));
+            return buf;
+        case SQL_BOOLEAN:
+            return *v ? "TRUE" : "FALSE";
+        case SQL_TYPE_DATE:
+            return "DATE '" + std::string(buf, DateTime::formatDate(buf, load<ISC_DATE>(v))) + "'";
+        case SQL_TYPE_TIME:
+            return "TIME '" + std::string(buf, DateTime::formatTime(buf, load<ISC_TIME>(v))) + "'";
+        case SQL_TIMESTAMP:
+            return "TIMESTAMP '" + std::string(buf, DateTime::formatTimestamp(buf, load<ISC_TIMESTAMP>(v), ' ')) + "'";
+        case SQL_TIME_TZ:
+            return "TIME '" + std::string(buf, DateTime::formatTime(buf, load<ISC_TIME_TZ>(v).utc_time)) + " UTC'";
+        case SQL_TIMESTAMP_TZ:
+            return "TIMESTAMP '" + std::string(buf,
+                    DateTime::formatTimestamp(buf, load<ISC_TIMESTAMP_TZ>(v).utc_timestamp, ' ')) + " UTC'";
+        case SQL_BLOB:
+            return "<blob>";
+        default:
+            return "<type " + std::to_string(p.type) + ">";
+    }
+}
+
+void Statement::checkSlowQuery(std::chrono::steady_clock::time_point start, uint64_t rows, const unsigned char* params) {
+    std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+    if (!SlowQueryLog::isSlow(elapsed))
+        return;
+
+    // a failing plan request must not fail the statement
+    if (!planCaptured) {
+        try {
+            capturePlan();
+        } catch (const FbException& e) {
+            char buf[256];
+            formatExceptionMessage(e, buf, 256);
+            plan = buf;
+            planCaptured = true;
+        }
+    }
+
+    SlowQueryLog::Record record;
+    record.time = std::chrono::system_clock::now();
+    record.elapsed = elapsed;
+    record.sql = sql;
+    record.rowsFetched = rows;
+    record.plan = plan;
+    record.detailedPlan = detailedPlan;
+
+    record.parameters.reserve(parametersCount);
+    for (unsigned j = 0; j < parametersCount; ++j)
+        record.parameters.push_back(formatParameter(params, parameters[j]));
+
+    SlowQueryLog::instance().log(std::move(record));
+}
+
 void Statement::close() {
     if (resSet_) {
+        if (cursorTimed) {
+            cursorTimed = false;
+            checkSlowQuery(cursorStart, cursorRows, cursorParameters.data());
+        }
         resSet_->close(status);
         resSet_->release();
         resSet_ = nullptr;
@@ -248,7 +614,434 @@ bool Statement::fetch() {
     if(!resSet_)
         throw std::logic_error("Statement: call open before!");
 
-    return resSet_->fetchNext(status, fieldsValueBuffer) == IStatus::RESULT_OK;
+    ScopedTimer timer(metrics ? &metrics->fetch : nullptr);
+    return fetched(resSet_->fetchNext(status, fieldsValueBuffer));
+}
+
+bool Statement::tryFetch(CallResult& result) {
+    if(!resSet_)
+        throw std::logic_error("Statement: call open before!");
+
+    CheckStatusWrapper* st = CallResult::status();
+    int ret;
+    {
+        ScopedTimer timer(metrics ? &metrics->fetch : nullptr);
+        ret = resSet_->fetchNext(st, fieldsValueBuffer);
+    }
+    if (ret == IStatus::RESULT_ERROR) {
+        result = CallResult(st->getErrors());
+        return false;
+    }
+    result = CallResult();
+    return fetched(ret);
+}
+
+bool Statement::fetched(int result) {
+    if (result != IStatus::RESULT_OK)
+        return false;
+
+    ++cursorRows;
+    countRows(1);
+    return true;
+}
+
+/*********************************************************
+ * Scrollable cursor
+ */
+void Statement::setScrollable(bool scrollable) {
+    this->scrollable = scrollable;
+}
+
+void Statement::checkScrollable() {
+    if(!resSet_)
+        throw std::logic_error("Statement: call open before!");
+
+    if (!scrollable)
+        throw std::logic_error("Statement: cursor not scrollable!");
+}
+
+bool Statement::fetchFirst() {
+    checkScrollable();
+
+    ScopedTimer timer(metrics ? &metrics->fetch : nullptr);
+    return fetched(resSet_->fetchFirst(status, fieldsValueBuffer));
+}
+
+bool Statement::fetchLast() {
+    checkScrollable();
+
+    ScopedTimer timer(metrics ? &metrics->fetch : nullptr);
+    return fetched(resSet_->fetchLast(status, fieldsValueBuffer));
+}
+
+bool Statement::fetchPrior() {
+    checkScrollable();
+
+    ScopedTimer timer(metrics ? &metrics->fetch : nullptr);
+    return fetched(resSet_->fetchPrior(status, fieldsValueBuffer));
+}
+
+bool Statement::fetchAbsolute(int position) {
+    checkScrollable();
+
+    ScopedTimer timer(metrics ? &metrics->fetch : nullptr);
+    return fetched(resSet_->fetchAbsolute(status, position, fieldsValueBuffer));
+}
+
+bool Statement::fetchRelative(int offset) {
+    checkScrollable();
+
+    ScopedTimer timer(metrics ? &metrics->fetch : nullptr);
+    return fetched(resSet_->fetchRelative(status, offset, fieldsValueBuffer));
+}
+
+// a NULL read into a plain member would be silently wrong
+void Statement::throwNullColumn(const BoundColumn& c) const {
+    throw std::invalid_argument("Row binding: NULL in column " + std::to_string(&c - boundColumns.data())
+        + ", bind it to std::optional!");
+}
+
+/*********************************************************
+ * Async
+ */
+const void* Statement::asyncKey() const {
+    // calls on one attachment are serialized by the executor
+    if (transaction && transaction->attachment)
+        return transaction->attachment;
+    return this;
+}
+
+std::future<void> Statement::executeAsync(AsyncExecutor& executor) {
+    return executor.submit(asyncKey(), [this] {
+        execute();
+    });
+}
+
+std::future<void> Statement::openAsync(AsyncExecutor& executor) {
+    return executor.submit(asyncKey(), [this] {
+        open();
+    });
+}
+
+std::future<size_t> Statement::fetchBlockAsync(AsyncExecutor& executor, ColumnBlock& block, size_t rows) {
+    return executor.submit(asyncKey(), [this, &block, rows] {
+        return fetchBlock(block, rows);
+    });
+}
+
+/*********************************************************
+ * Batch
+ */
+void Statement::setBatchBufferSize(unsigned bytes) {
+    if (batch_)
+        throw std::logic_error("Statement: batch already started!");
+
+    batchBufferSize = bytes;
+}
+
+void Statement::createBatch() {
+    //!! call checkTransaction and prepare before createBatch()
+    bool hasBlob = false;
+    for (unsigned j = 0; j < parametersCount; ++j) {
+        if (parameters[j].type == SQL_BLOB)
+            hasBlob = true;
+    }
+
+    // room for the last row going past the flush threshold
+    unsigned serverBufferSize = batchBufferSize < 128 * 1024 * 1024 ? batchBufferSize * 2 : 256 * 1024 * 1024;
+
+    IXpbBuilder* pb = master->getUtilInterface()->getXpbBuilder(status, IXpbBuilder::BATCH, NULL, 0);
+    try {
+        pb->insertInt(status, IBatch::TAG_MULTIERROR, 1);
+        pb->insertInt(status, IBatch::TAG_RECORD_COUNTS, 1);
+        pb->insertInt(status, IBatch::TAG_BUFFER_BYTES_SIZE, serverBufferSize);
+        if (hasBlob)
+            pb->insertInt(status, IBatch::TAG_BLOB_POLICY, IBatch::BLOB_ID_ENGINE);
+
+        batch_ = stmt_->createBatch(status, inMeta, pb->getBufferLength(status), pb->getBuffer(status));
+    } catch (...) {
+        pb->dispose();
+        throw;
+    }
+    pb->dispose();
+}
+
+void Statement::addRow() {
+    checkTransaction();
+
+    if (!isPrepared)
+        prepare();
+
+    if (!batch_)
+        createBatch();
+
+    batch_->add(status, 1, parametersValueBuffer);
+    ++batchPendingRows;
+    // the batch buffer holds aligned messages, as counted by addMessages()
+    batchPendingBytes += inMeta->getAlignedLength(status);
+
+    if (batchPendingBytes >= batchBufferSize)
+        flushBatch();
+}
+
+void Statement::addMessages(const void* messages, unsigned count) {
+    checkTransaction();
+
+    if (!isPrepared)
+        prepare();
+
+    if (!batch_)
+        createBatch();
+
+    const unsigned stride = inMeta->getAlignedLength(status);
+    const unsigned char* p = (const unsigned char*) messages;
+
+    // slices that fill the batch buffer up to the flush threshold
+    while (count) {
+        unsigned room = batchPendingBytes < batchBufferSize ? (batchBufferSize - batchPendingBytes) / stride : 0;
+        unsigned n = count < room ? count : (room ? room : 1);
+
+        batch_->add(status, n, p);
+        batchPendingRows += n;
+        batchPendingBytes += n * stride;
+        p += size_t(n) * stride;
+        count -= n;
+
+        if (batchPendingBytes >= batchBufferSize)
+            flushBatch();
+    }
+}
+
+unsigned Statement::getParametersAlignedLength() {
+    checkTransaction();
+
+    if (!isPrepared)
+        prepare();
+
+    return inMeta ? inMeta->getAlignedLength(status) : 0;
+}
+
+void Statement::flushBatch() {
+    if (!batchPendingRows)
+        return;
+
+    unsigned firstRow = batchResult.states.size();
+    IBatchCompletionState* cs = batch_->execute(status, transaction->tra_);
+
+    batchPendingRows = 0;
+    batchPendingBytes = 0;
+
+    IStatus* rowStatus = master->getStatus();
+    try {
+        unsigned size = cs->getSize(status);
+        for (unsigned j = 0; j < size; ++j) {
+            int state = cs->getState(status, j);
+            batchResult.states.push_back(state);
+            if (state > 0)
+                batchResult.affectedRecords += state;
+        }
+
+        char buf[256];
+        for (unsigned pos = cs->findError(status, 0); pos != IBatchCompletionState::NO_MORE_ERRORS;
+                pos = cs->findError(status, pos + 1)) {
+            rowStatus->init();
+            cs->getStatus(status, rowStatus, pos);
+            formatStatusMessage(rowStatus, buf, 256);
+            batchResult.errors.emplace_back(firstRow + pos, buf);
+        }
+    } catch (...) {
+        rowStatus->dispose();
+        cs->dispose();
+        throw;
+    }
+    rowStatus->dispose();
+    cs->dispose();
+}
+
+Statement::BatchResult Statement::executeBatch() {
+    if (!batch_)
+        return BatchResult();
+
+    checkTransaction();
+    ScopedTimer timer(metrics ? &metrics->execute : nullptr);
+    countExecute();
+    flushBatch();
+
+    BatchResult ret = std::move(batchResult);
+    batchResult = BatchResult();
+    return ret;
+}
+
+void Statement::cancelBatch() {
+    if (batch_ && batchPendingRows)
+        batch_->cancel(status);
+
+    batchPendingRows = 0;
+    batchPendingBytes = 0;
+    batchResult = BatchResult();
+}
+
+void Statement::releaseBatch() {
+    if (batch_) {
+        batch_->release();
+        batch_ = nullptr;
+    }
+    batchPendingRows = 0;
+    batchPendingBytes = 0;
+    batchResult = BatchResult();
+}
+
+// the type switch out of the row loop
+template <unsigned TYPE>
+static void decodeDateTimeColumn(int64_t* out, const unsigned char* row, unsigned stride,
+        unsigned offset, unsigned nullOffset, size_t rows) {
+    for (size_t r = 0; r < rows; ++r, row += stride)
+        out[r] = *((const short*) (row + nullOffset)) ? 0 : DateTime::micros(row + offset, TYPE);
+}
+
+static void decodeDateTimes(std::vector<int64_t>& values, const unsigned char* row, unsigned stride,
+        const Statement::Field& f, size_t rows) {
+    values.resize(rows);
+    switch (f.type) {
+        case SQL_TYPE_DATE:
+            decodeDateTimeColumn<SQL_TYPE_DATE>(values.data(), row, stride, f.offset, f.nullOffset, rows);
+            break;
+        case SQL_TYPE_TIME:
+            decodeDateTimeColumn<SQL_TYPE_TIME>(values.data(), row, stride, f.offset, f.nullOffset, rows);
+            break;
+        case SQL_TIMESTAMP:
+            decodeDateTimeColumn<SQL_TIMESTAMP>(values.data(), row, stride, f.offset, f.nullOffset, rows);
+            break;
+        case SQL_TIME_TZ:
+            decodeDateTimeColumn<SQL_TIME_TZ>(values.data(), row, stride, f.offset, f.nullOffset, rows);
+            break;
+        default:
+            decodeDateTimeColumn<SQL_TIMESTAMP_TZ>(values.data(), row, stride, f.offset, f.nullOffset, rows);
+            break;
+    }
+}
+
+template <typename T, typename V>
+static void copyColumn(std::vector<V>& values, const unsigned char* row, unsigned stride,
+        unsigned offset, unsigned nullOffset, size_t rows) {
+    values.resize(rows);
+    V* out = values.data();
+    for (size_t r = 0; r < rows; ++r, row += stride) {
+        T v;
+        std::memcpy(&v, row + offset, sizeof (T));
+        out[r] = *((const short*) (row + nullOffset)) ? V() : (V) v;
+    }
+}
+
+size_t Statement::fetchBlock(ColumnBlock& block, size_t rows) {
+    if(!resSet_)
+        throw std::logic_error("Statement: call open before!");
+
+    return fillBlock(block, rows, false, 0);
+}
+
+size_t Statement::fetchBlockAt(ColumnBlock& block, int position, size_t rows) {
+    checkScrollable();
+
+    return fillBlock(block, rows, true, position);
+}
+
+size_t Statement::fillBlock(ColumnBlock& block, size_t rows, bool absolute, int position) {
+    // rows laid out like a batch: each message starts aligned as its first column
+    const unsigned stride = rowMeta->getAlignedLength(status);
+    if (block.rowBuffer.size() < rows * stride)
+        block.rowBuffer.resize(rows * stride);
+
+    size_t n = 0;
+    if (absolute && rows) {
+        if (resSet_->fetchAbsolute(status, position, block.rowBuffer.data()) == IStatus::RESULT_OK)
+            n = 1;
+        else
+            rows = 0;
+    }
+    while (n < rows && resSet_->fetchNext(status, block.rowBuffer.data() + n * stride) == IStatus::RESULT_OK)
+        ++n;
+
+    block.rows = n;
+    block.columns.resize(fieldsCount);
+    cursorRows += n;
+    countRows(n);
+
+    // one type dispatch per column, then a tight loop over the rows
+    const unsigned char* base = block.rowBuffer.data();
+    for (unsigned j = 0; j < fieldsCount; ++j) {
+        const Field& f = fields[j];
+        ColumnBlock::Column& col = block.columns[j];
+        col.scale = f.scale;
+
+        col.nulls.assign((n + 63) / 64, 0);
+        const unsigned char* row = base + f.nullOffset;
+        for (size_t r = 0; r < n; ++r, row += stride) {
+            if (*((const short*) row))
+                col.nulls[r >> 6] |= uint64_t(1) << (r & 63);
+        }
+
+        switch (f.type) {
+            case SQL_SHORT:
+                col.type = ColumnBlock::ColumnType::INTEGER;
+                copyColumn<ISC_SHORT>(col.integers, base, stride, f.offset, f.nullOffset, n);
+                break;
+            case SQL_LONG:
+                col.type = ColumnBlock::ColumnType::INTEGER;
+                copyColumn<ISC_LONG>(col.integers, base, stride, f.offset, f.nullOffset, n);
+                break;
+            case SQL_INT64:
+                col.type = ColumnBlock::ColumnType::INTEGER;
+                copyColumn<ISC_INT64>(col.integers, base, stride, f.offset, f.nullOffset, n);
+                break;
+            case SQL_TYPE_DATE:
+            case SQL_TYPE_TIME:
+            case SQL_TIMESTAMP:
+            case SQL_TIME_TZ:
+            case SQL_TIMESTAMP_TZ:
+                col.type = ColumnBlock::ColumnType::DATETIME;
+                decodeDateTimes(col.integers, base, stride, f, n);
+                break;
+            case SQL_FLOAT:
+                col.type = ColumnBlock::ColumnType::DOUBLE;
+                copyColumn<float>(col.doubles, base, stride, f.offset, f.nullOffset, n);
+                break;
+            case SQL_DOUBLE:
+                col.type = ColumnBlock::ColumnType::DOUBLE;
+                copyColumn<double>(col.doubles, base, stride, f.offset, f.nullOffset, n);
+                break;
+            case SQL_VARYING:
+                col.type = ColumnBlock::ColumnType::STRING;
+                col.offsets.resize(n + 1);
+                col.chars.resize(n * f.length);
+                col.offsets[0] = 0;
+                row = base;
+                for (size_t r = 0; r < n; ++r, row += stride) {
+                    unsigned short len = 0;
+                    if (!*((const short*) (row + f.nullOffset)))
+                        len = *((const unsigned short*) (row + f.offset));
+                    std::memcpy(col.chars.data() + col.offsets[r], row + f.offset + sizeof (short), len);
+                    col.offsets[r + 1] = col.offsets[r] + len;
+                }
+                col.chars.resize(col.offsets[n]);
+                break;
+            default:
+                col.type = f.type == SQL_TEXT ? ColumnBlock::ColumnType::STRING : ColumnBlock::ColumnType::BINARY;
+                col.offsets.resize(n + 1);
+                col.chars.resize(n * f.length);
+                col.offsets[0] = 0;
+                row = base;
+                for (size_t r = 0; r < n; ++r, row += stride) {
+                    unsigned len = *((const short*) (row + f.nullOffset)) ? 0 : f.length;
+                    std::memcpy(col.chars.data() + col.offsets[r], row + f.offset, len);
+                    col.offsets[r + 1] = col.offsets[r] + len;
+                }
+                col.chars.resize(col.offsets[n]);
+                break;
+        }
+    }
+
+    return n;
 }
 
 void Statement::initParametersByName() {
@@ -283,7 +1076,13 @@ void Statement::initParametersByName() {
                 }
                 if (k > 0 && k < 32) {
                     paramName[k] = '\0';
-                    namedParameters[paramName] = parametersCount++;
+                    auto it = namedParameters.begin();
+                    while (it != namedParameters.end() && it->first != paramName)
+                        ++it;
+                    if (it == namedParameters.end())
+                        namedParameters.emplace_back(paramName, parametersCount++);
+                    else
+                        it->second = parametersCount++;
                 } else
                     throw std::invalid_argument("invalid SQL statement !");
                 break;
@@ -297,11 +1096,11 @@ void Statement::initParametersByName() {
 /*********************************************************
  * Field 
  */
-Statement::Field Statement::fieldByName(const char* name) {
-    checkTransaction();
-
-    if (!isPrepared)
+Statement::Field Statement::fieldByName(std::string_view name) {
+    if (!isPrepared) {
+        checkTransaction();
         prepare();
+    }
 
     auto it = namedFields.find(name);
 
@@ -313,20 +1112,79 @@ Statement::Field Statement::fieldByName(const char* name) {
 }
 
 Statement::Field Statement::field(unsigned int idx) {
-    checkTransaction();
-
-    if (!isPrepared)
+    if (!isPrepared) {
+        checkTransaction();
         prepare();
+    }
 
     if (idx >= fieldsCount)
         return {nullptr};
     return fields[idx];
 }
 
+Statement::Field Statement::resolveField(std::string_view name) {
+    Field ret = fieldByName(name);
+
+    if (!ret)
+        throw std::invalid_argument("Statement: unknown field " + std::string(name) + "!");
+
+    return ret;
+}
+
 Statement::Field::operator bool() const {
     return stmt != nullptr;
 }
 
+bool Statement::Field::isNull() const {
+    assert(stmt);
+
+    return *((short*) (stmt->fieldsValueBuffer + nullOffset)) != 0;
+}
+
+// number at the start of a text value, leading blanks skipped
+template <typename T>
+static T parseNumber(std::string_view text) {
+    const char* p = text.data();
+    const char* end = p + text.size();
+
+    while (p < end && *p == ' ')
+        ++p;
+    if (p < end && *p == '+')
+        ++p;
+
+    T ret = 0;
+    std::from_chars(p, end, ret);
+    return ret;
+}
+
+std::string_view Statement::Field::asStringView(bool trimPadding) const {
+    assert(stmt);
+
+    if (*((short*) (stmt->fieldsValueBuffer + nullOffset))) {
+        return std::string_view();
+    }
+
+    const char* p = (const char*) (stmt->fieldsValueBuffer + offset);
+    size_t len;
+
+    switch (type) {
+        case SQL_TEXT:
+            len = length;
+            if (trimPadding) {
+                while (len > 0 && p[len - 1] == ' ')
+                    --len;
+            }
+            break;
+        case SQL_VARYING:
+            len = *((const unsigned short*) p);
+            p += sizeof (short);
+            break;
+        default:
+            return std::string_view();
+    }
+    return std::string_view(p, len);
+}
+
 int64_t Statement::Field::asInteger() const {
     assert(stmt);
 
@@ -335,16 +1193,11 @@ int64_t Statement::Field::asInteger() const {
     }
 
     int64_t ret;
-    std::string tmp;
 
     switch (type) {
         case SQL_TEXT:
-            tmp.assign((char*) (stmt->fieldsValueBuffer + offset), length);
-            ret = strtoll(tmp.c_str(), nullptr, 0);
-            break;
         case SQL_VARYING:
-            tmp.assign((char*) (stmt->fieldsValueBuffer + offset + sizeof (short)), length);
-            ret = strtoll(tmp.c_str(), nullptr, 0);
+            ret = parseNumber<int64_t>(asStringView());
             break;
         case SQL_SHORT:
             ret = *((const ISC_SHORT*) (stmt->fieldsValueBuffer + offset));
@@ -355,6 +1208,10 @@ int64_t Statement::Field::asInteger() const {
         case SQL_INT64:
             ret = *((const ISC_INT64*) (stmt->fieldsValueBuffer + offset));
             break;
+        case SQL_INT128:
+        case SQL_DEC16:
+        case SQL_DEC34:
+            return asDecimal().toInt64();
         case SQL_FLOAT:
             ret = *((const float*) (stmt->fieldsValueBuffer + offset));
             break;
@@ -366,6 +1223,10 @@ int64_t Statement::Field::asInteger() const {
             ret = 0;
             break;
     }
+
+    // NUMERIC/DECIMAL
+    if (scale)
+        ret = Decimal(ret, scale).toInt64();
     return ret;
 }
 
@@ -383,22 +1244,31 @@ std::string Statement::Field::asString() const {
             ret.assign((char*) (stmt->fieldsValueBuffer + offset), length);
             break;
         case SQL_VARYING:
-            ret.assign((char*) (stmt->fieldsValueBuffer + offset + sizeof (short)), length);
+            ret.assign((char*) (stmt->fieldsValueBuffer + offset + sizeof (short)),
+                    *((const unsigned short*) (stmt->fieldsValueBuffer + offset)));
             break;
         case SQL_SHORT:
-            ret = std::to_string(*((const ISC_SHORT*) (stmt->fieldsValueBuffer + offset)));
-            break;
         case SQL_LONG:
-            ret = std::to_string(*((const ISC_LONG*) (stmt->fieldsValueBuffer + offset)));
-            break;
         case SQL_INT64:
-            ret = std::to_string(*((const ISC_INT64*) (stmt->fieldsValueBuffer + offset)));
+            if (scale)
+                ret = asDecimal().toString();
+            else
+                ret = std::to_string(asInteger());
+            break;
+        case SQL_INT128:
+            ret = asDecimal().toString();
+            break;
+        case SQL_DEC16:
+            ret = Decimal::decFloatString(*((const FB_DEC16*) (stmt->fieldsValueBuffer + offset)));
+            break;
+        case SQL_DEC34:
+            ret = Decimal::decFloatString(*((const FB_DEC34*) (stmt->fieldsValueBuffer + offset)));
             break;
         case SQL_FLOAT:
             ret = std::to_string(*((const float*) (stmt->fieldsValueBuffer + offset)));
             break;
         case SQL_DOUBLE:
-            ret = std::to_string(*((const float*) (stmt->fieldsValueBuffer + offset)));
+            ret = std::to_string(*((const double*) (stmt->fieldsValueBuffer + offset)));
             break;
         case SQL_NULL:
         default:
@@ -415,7 +1285,6 @@ double Statement::Field::asDouble() const {
     }
 
     double ret;
-    std::string tmp;
 
     switch (type) {
         case SQL_SHORT:
@@ -425,8 +1294,17 @@ double Statement::Field::asDouble() const {
             ret = *((const ISC_LONG*) (stmt->fieldsValueBuffer + offset));
             break;
         case SQL_INT64:
+            // exact up to 2^53, then correctly rounded from the digits
+            if (scale)
+                return asDecimal().toDouble();
             ret = *((const ISC_INT64*) (stmt->fieldsValueBuffer + offset));
             break;
+        case SQL_INT128:
+            return asDecimal().toDouble();
+        case SQL_DEC16:
+            return parseNumber<double>(Decimal::decFloatString(*((const FB_DEC16*) (stmt->fieldsValueBuffer + offset))));
+        case SQL_DEC34:
+            return parseNumber<double>(Decimal::decFloatString(*((const FB_DEC34*) (stmt->fieldsValueBuffer + offset))));
         case SQL_FLOAT:
             ret = *((const float*) (stmt->fieldsValueBuffer + offset));
             break;
@@ -434,157 +1312,246 @@ double Statement::Field::asDouble() const {
             ret = *((const double*) (stmt->fieldsValueBuffer + offset));
             break;
         case SQL_TEXT:
-            tmp.assign((char*) (stmt->fieldsValueBuffer + offset), length);
-            ret = strtod(tmp.c_str(), nullptr);
-            break;
         case SQL_VARYING:
-            tmp.assign((char*) (stmt->fieldsValueBuffer + offset + sizeof (short)), length);
-            ret = strtod(tmp.c_str(), nullptr);
+            ret = parseNumber<double>(asStringView());
             break;
         default:
             ret = 0;
             break;
     }
+
+    // SMALLINT and INTEGER based NUMERIC/DECIMAL
+    if (scale)
+        ret = Decimal((int64_t) ret, scale).toDouble();
     return ret;
 }
 
-std::string Statement::Field::formatDate(const std::string &format) const {
-    struct tm times;
-    char buff[30];
+Decimal Statement::Field::asDecimal() const {
+    assert(stmt);
 
+    if (*((short*) (stmt->fieldsValueBuffer + nullOffset))) {
+        return Decimal();
+    }
+
+    const unsigned char* value = stmt->fieldsValueBuffer + offset;
+
+    switch (type) {
+        case SQL_TEXT:
+        case SQL_VARYING:
+            return Decimal::parse(asStringView());
+        case SQL_FLOAT:
+            return ParameterWriter<float>::decimal(*((const float*) value));
+        case SQL_DOUBLE:
+            return ParameterWriter<double>::decimal(*((const double*) value));
+        default: {
+            ColumnReader<Decimal>::Read read = ColumnReader<Decimal>::select(type, scale);
+            if (!read)
+                throw std::invalid_argument("Field: invalid data type!");
+            return read(value, length, scale);
+        }
+    }
+}
+
+int64_t Statement::Field::asEpochMicros() const {
     assert(stmt);
 
+    if (!DateTime::accepts(type))
+        throw std::invalid_argument("Field: invalid data type!");
+
     if (*((short*) (stmt->fieldsValueBuffer + nullOffset))) {
         return 0;
     }
 
-    switch (type) {
-        case SQL_TYPE_DATE:
-            isc_decode_sql_date((const ISC_DATE*) (stmt->fieldsValueBuffer + offset), &times);
-            strftime(buff, 30, format.c_str(), &times);
-            break;
-        case SQL_TIMESTAMP:
-            isc_decode_timestamp((const ISC_TIMESTAMP*) (stmt->fieldsValueBuffer + offset), &times);
-            strftime(buff, 30, format.c_str(), &times);
-            break;
-        default:
-            return std::string();
-            break;
+    return DateTime::micros(stmt->fieldsValueBuffer + offset, type);
+}
+
+DateTime::Timestamp Statement::Field::asTimestamp() const {
+    return DateTime::timePoint(asEpochMicros());
+}
+
+std::string Statement::Field::asIsoString() const {
+    assert(stmt);
+
+    if (*((short*) (stmt->fieldsValueBuffer + nullOffset)) || !DateTime::accepts(type)) {
+        return std::string();
     }
 
-    return buff;
+    char buff[DateTime::TIMESTAMP_LENGTH + 16];
+    return std::string(buff, DateTime::format(buff, stmt->fieldsValueBuffer + offset, type));
+}
+
+// strftime() conversions that need a date: %a %b %c %d %e %j %m %x %Y and the like
+static bool hasDateField(const std::string& format) {
+    for (size_t j = 0; j + 1 < format.size(); ++j) {
+        if (format[j] != '%')
+            continue;
+        char c = format[++j];
+        if ((c == 'E' || c == 'O') && j + 1 < format.size())
+            c = format[++j];
+        if (c != '%' && std::strchr("aAbBcCdDeFgGhjmuUVwWxyY", c))
+            return true;
+    }
+    return false;
+}
+
+std::string Statement::Field::formatDate(const std::string &format) const {
+    assert(stmt);
+
+    if (*((short*) (stmt->fieldsValueBuffer + nullOffset)) || !DateTime::accepts(type)) {
+        return std::string();
+    }
+
+    // a TIME has no date to format
+    if ((type == SQL_TYPE_TIME || type == SQL_TIME_TZ) && hasDateField(format))
+        return std::string();
+
+    const int64_t micros = DateTime::micros(stmt->fieldsValueBuffer + offset, type);
+    const ISC_TIMESTAMP ts = DateTime::timestamp(micros);
+
+    if (format == "%Y-%m-%d") {
+        char buff[DateTime::DATE_LENGTH + 16];
+        return std::string(buff, DateTime::formatDate(buff, ts.timestamp_date));
+    }
+
+    // struct tm from the day count, no time zone lookup
+    int64_t year;
+    unsigned month, day;
+    DateTime::civil(ts.timestamp_date, year, month, day);
+    const unsigned seconds = ts.timestamp_time / ISC_TIME_SECONDS_PRECISION;
+    const int64_t days = (int64_t) ts.timestamp_date - DateTime::EPOCH_DATE;
+
+    struct tm times = {};
+    times.tm_year = (int) (year - 1900);
+    times.tm_mon = month - 1;
+    times.tm_mday = day;
+    times.tm_hour = seconds / 3600;
+    times.tm_min = seconds / 60 % 60;
+    times.tm_sec = seconds % 60;
+    times.tm_wday = (int) (((days + 4) % 7 + 7) % 7); // 1970-01-01 was a Thursday
+    times.tm_yday = (int) (ts.timestamp_date - DateTime::date(year, 1, 1));
+
+    char buff[128];
+    size_t len = strftime(buff, sizeof (buff), format.c_str(), &times);
+    return std::string(buff, len);
+}
+
+ISC_QUAD Statement::Field::asBlobId() const {
+    assert(stmt);
+
+    if (type != SQL_BLOB)
+        throw std::invalid_argument("Field: invalid data type!");
+
+    if (*((short*) (stmt->fieldsValueBuffer + nullOffset))) {
+        return ISC_QUAD{0, 0};
+    }
+
+    return *((const ISC_QUAD*) (stmt->fieldsValueBuffer + offset));
 }
 
 /*********************************************************
  * Parameter
  */
-Statement::Parameter Statement::paramByName(const char* name) {
-    checkTransaction();
-
-    if (!isPrepared)
+Statement::Parameter Statement::paramByName(std::string_view name) {
+    if (!isPrepared) {
+        checkTransaction();
         prepare();
+    }
 
-    auto it = namedParameters.find(name);
-
-    if (it == namedParameters.end())
-        return {nullptr};
+    for (const auto &it : namedParameters) {
+        if (it.first == name)
+            return parameters[it.second];
+    }
 
-    return parameters[it->second];
+    return {nullptr};
 }
 
 Statement::Parameter Statement::parameter(unsigned int idx) {
-    checkTransaction();
-
-    if (!isPrepared)
+    if (!isPrepared) {
+        checkTransaction();
         prepare();
+    }
 
     if (idx >= parametersCount)
         return {nullptr};
     return parameters[idx];
 }
 
+Statement::Parameter Statement::resolveParam(std::string_view name) {
+    Parameter ret = paramByName(name);
+
+    if (!ret)
+        throw std::invalid_argument("Statement: unknown parameter " + std::string(name) + "!");
+
+    return ret;
+}
+
 Statement::Parameter::operator bool() const {
     return stmt != nullptr;
 }
 
-void Statement::Parameter::setInt(uint64_t v) {
+void Statement::Parameter::setInt(int64_t v) {
     assert(stmt);
 
     *((short*) (stmt->parametersValueBuffer + nullOffset)) = 0;
-
-    switch (type) {
-        case SQL_SHORT:
-            *((ISC_SHORT*) (stmt->parametersValueBuffer + offset)) = v;
-            break;
-        case SQL_LONG:
-            *((ISC_LONG*) (stmt->parametersValueBuffer + offset)) = v;
-            break;
-        case SQL_INT64:
-            *((ISC_INT64*) (stmt->parametersValueBuffer + offset)) = v;
-            break;
-        default:
-            throw std::invalid_argument("Binding parameter: invalid data type!");
-            break;
-    }
+    ParameterWriter<int64_t>::write(stmt->parametersValueBuffer + offset, type, length, scale, v);
 }
 
 void Statement::Parameter::setDouble(double v) {
     assert(stmt);
 
     *((short*) (stmt->parametersValueBuffer + nullOffset)) = 0;
+    ParameterWriter<double>::write(stmt->parametersValueBuffer + offset, type, length, scale, v);
+}
 
-    switch (type) {
-        case SQL_FLOAT:
-            *((float*) (stmt->parametersValueBuffer + offset)) = v;
-            break;
-        case SQL_DOUBLE:
-            *((double*) (stmt->parametersValueBuffer + offset)) = v;
-            break;
-        case SQL_SHORT:
-            *((ISC_SHORT*) (stmt->parametersValueBuffer + offset)) = (ISC_SHORT) std::floor(v + 0.5);
-            break;
-        case SQL_LONG:
-            *((ISC_LONG*) (stmt->parametersValueBuffer + offset)) = (ISC_LONG) std::floor(v + 0.5);
-            break;
-        case SQL_INT64:
-            *((ISC_INT64*) (stmt->parametersValueBuffer + offset)) = (ISC_INT64) std::floor(v + 0.5);
-            break;
-        default:
-            throw std::invalid_argument("Binding parameter: invalid data type!");
-            break;
-    }
+void Statement::Parameter::setDecimal(const Decimal& v) {
+    assert(stmt);
+
+    *((short*) (stmt->parametersValueBuffer + nullOffset)) = 0;
+    ParameterWriter<Decimal>::write(stmt->parametersValueBuffer + offset, type, length, scale, v);
+}
+
+void Statement::Parameter::setTimestamp(DateTime::Timestamp v) {
+    assert(stmt);
+
+    *((short*) (stmt->parametersValueBuffer + nullOffset)) = 0;
+    ParameterWriter<DateTime::Timestamp>::write(stmt->parametersValueBuffer + offset, type, length, scale, v);
 }
 
 void Statement::Parameter::setText(const char* v) {
+    setText(std::string_view(v));
+}
+
+void Statement::Parameter::setText(std::string_view v) {
     assert(stmt);
 
-    unsigned short len = std::strlen(v);
+    *((short*) (stmt->parametersValueBuffer + nullOffset)) = 0;
+    ParameterWriter<std::string_view>::write(stmt->parametersValueBuffer + offset, type, length, scale, v);
+}
+
+void Statement::Parameter::setBlob(const void* data, unsigned len) {
+    assert(stmt);
 
-    assert(len <= length);
+    if (type != SQL_BLOB)
+        throw std::invalid_argument("Binding parameter: invalid data type!");
+
+    if (!stmt->batch_)
+        stmt->createBatch();
 
     *((short*) (stmt->parametersValueBuffer + nullOffset)) = 0;
 
-    char *p;
+    stmt->batch_->addBlob(stmt->status, len, data,
+            (ISC_QUAD*) (stmt->parametersValueBuffer + offset), 0, nullptr);
+    stmt->batchPendingBytes += len;
+}
 
-    switch (type) {
-        case SQL_TEXT:
-            p = (char*) (stmt->parametersValueBuffer + offset);
-            std::memcpy(p, v, len);
-            if (len < length) {
-                p += len;
-                std::memset(p, ' ', length - len);
-            }
-            break;
-        case SQL_VARYING:
-            *(short*) (stmt->parametersValueBuffer + offset) = len;
-            p = (char*) (stmt->parametersValueBuffer + offset + sizeof (short));
-            std::memcpy(p, v, len);
-            break;
+void Statement::Parameter::setBlobId(const ISC_QUAD& id) {
+    assert(stmt);
 
-        default:
-            throw std::invalid_argument("Binding parameter: invalid data type!");
-            break;
-    }
+    if (type != SQL_BLOB)
+        throw std::invalid_argument("Binding parameter: invalid data type!");
+
+    *((short*) (stmt->parametersValueBuffer + nullOffset)) = 0;
+    *((ISC_QUAD*) (stmt->parametersValueBuffer + offset)) = id;
 }
 
 void Statement::Parameter::setNull() {
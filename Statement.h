@@ -6,7 +6,21 @@
 #ifndef STATEMENT_H
 #define STATEMENT_H
 
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
+#include <vector>
+#include "AsyncExecutor.h"
+#include "CallResult.h"
+#include "ColumnBlock.h"
+#include "DateTime.h"
+#include "Decimal.h"
+#include "RowBinding.h"
+#include "SlowQueryLog.h"
 #include "Transaction.h"
 
 class Statement {
@@ -19,11 +33,29 @@ public:
         unsigned length = 0;
         unsigned offset = 0;
         unsigned nullOffset= 0;
+        int scale = 0; // NUMERIC/DECIMAL: value * 10^scale
         explicit operator bool() const;
+        bool isNull() const;
+        // scaled numbers: the fraction is truncated
         int64_t asInteger() const;
         double asDouble() const;
+        // exact value of integer, NUMERIC/DECIMAL, INT128 and DECFLOAT columns
+        Decimal asDecimal() const;
         std::string asString() const;
+        // text columns only: points into the fetched row, valid until the next fetch
+        std::string_view asStringView(bool trimPadding = false) const;
+        // DATE, TIME, TIMESTAMP and the time zone types, in UTC: microseconds
+        // from 1970-01-01, or from midnight for TIME
+        int64_t asEpochMicros() const;
+        DateTime::Timestamp asTimestamp() const;
+        // ISO 8601, 2026-10-17T12:34:56.7890; a Z follows the time zone types
+        std::string asIsoString() const;
+        // strftime() format; the default one takes the ISO 8601 fast path. The
+        // time zone types are formatted in UTC; TIME columns give an empty
+        // string when the format has date fields
         std::string formatDate(const std::string &format = "%Y-%m-%d") const;
+        // BLOB columns: read the content with Blob::open()
+        ISC_QUAD asBlobId() const;
     };
 
     class Parameter {
@@ -33,63 +65,465 @@ public:
         unsigned length = 0;
         unsigned offset = 0;
         unsigned nullOffset= 0;
+        int scale = 0;
 
         explicit operator bool() const;
 
-        void setInt(uint64_t v);
+        // scaled to the parameter: setInt(3) on NUMERIC(9,2) binds 3.00
+        void setInt(int64_t v);
         void setDouble(double v);
+        void setDecimal(const Decimal& v);
+        // DATE (the day in UTC), TIME (the time of day in UTC), TIMESTAMP,
+        // the time zone types (in UTC) and text (ISO 8601)
+        void setTimestamp(DateTime::Timestamp v);
         void setText(const char* v);
+        void setText(std::string_view v);
+        // batch mode only: the blob travels in the batch stream of the next addRow()
+        void setBlob(const void* data, unsigned len);
+        // id of a blob written with Blob::create()
+        void setBlobId(const ISC_QUAD& id);
         void setNull();
     };
 
+    // result of executeBatch()
+    struct BatchResult {
+        // per row: affected records, BATCH_EXECUTE_FAILED or BATCH_SUCCESS_NO_INFO
+        std::vector<int> states;
+        // failed rows: row number and formatted error
+        std::vector<std::pair<unsigned, std::string> > errors;
+        uint64_t affectedRecords = 0;
+    };
+
+    static const int BATCH_EXECUTE_FAILED = -1;
+    static const int BATCH_SUCCESS_NO_INFO = -2;
+
+    // range of rows decoded into Row, see rows()
+    template <typename Row>
+    class RowRange {
+    public:
+        class iterator {
+        public:
+            iterator(Statement* stmt) : stmt(stmt) {
+                if (stmt && !stmt->fetchInto(row))
+                    this->stmt = nullptr;
+            }
+
+            const Row& operator*() const {
+                return row;
+            }
+
+            const Row* operator->() const {
+                return &row;
+            }
+
+            iterator& operator++() {
+                if (!stmt->fetchInto(row))
+                    stmt = nullptr;
+                return *this;
+            }
+
+            bool operator!=(const iterator& other) const {
+                return stmt != other.stmt;
+            }
+        private:
+            Statement* stmt;
+            Row row;
+        };
+
+        explicit RowRange(Statement* stmt) : stmt(stmt) {
+        }
+
+        iterator begin() {
+            return iterator(stmt);
+        }
+
+        iterator end() {
+            return iterator(nullptr);
+        }
+    private:
+        Statement* stmt;
+    };
+
     Statement();
     void setSql(std::string sql);
     void setTransaction(Transaction* transaction);
 
-    Field fieldByName(const char* name);
+    Field fieldByName(std::string_view name);
     Field field(unsigned int idx);
             
-    Parameter paramByName(const char* name);
+    Parameter paramByName(std::string_view name);
     Parameter parameter(unsigned int idx);
 
+    // handles valid until setSql()/reset(): resolve once, use in the fetch loop
+    Field resolveField(std::string_view name);
+    Parameter resolveParam(std::string_view name);
+
     virtual ~Statement();
     void open();
     void execute();
+    // one argument per parameter, in order, written straight into the input
+    // message: integers, floating point, bool, text (std::string_view,
+    // std::string, const char*), Decimal, std::chrono::system_clock time
+    // points, ISC_QUAD blob ids; std::nullopt, an empty std::optional or a
+    // null const char* bind NULL
+    template <typename... Args>
+    void bind(const Args&... args);
+    template <typename... Args>
+    void open(const Args&... args);
+    template <typename... Args>
+    void execute(const Args&... args);
+    // execute() and fetch() without FbException for expected failures, e.g.
+    // unique key violations or lock conflicts: the error comes back as a
+    // CallResult. Prepare errors and misuse still throw.
+    CallResult tryExecute();
+    template <typename... Args>
+    CallResult tryExecute(const Args&... args);
+    // false at the end of the cursor or on error, told apart by result
+    bool tryFetch(CallResult& result);
     void close();
     void reset();
     bool fetch();
+    size_t fetchBlock(ColumnBlock& block, size_t rows);
+
+    // scrollable cursor from the next open(), for the positioning fetches below
+    void setScrollable(bool scrollable);
+    bool fetchFirst();
+    bool fetchLast();
+    bool fetchPrior();
+    // 1 based, negative counts from the end
+    bool fetchAbsolute(int position);
+    bool fetchRelative(int offset);
+    // rows from position on, positioned with fetchAbsolute()
+    size_t fetchBlockAt(ColumnBlock& block, int position, size_t rows);
     bool bof();
     bool eof();
     void next();
     uint64_t getAffectedRecords();
+    // message buffers and column/parameter descriptors share one block,
+    // reused by the next statement when it fits; resets the statement
+    void setMemoryResource(std::pmr::memory_resource* resource);
+    static const size_t ARENA_ALIGNMENT = 64;
+
+    // output message converted by the server, from the next prepare: the
+    // row arrives with the chosen types in a layout known in advance.
+    // IMetadataBuilder has no offsets to set: getMetadata() places each value
+    // at its natural alignment followed by its null indicator, in column
+    // order, so the layout follows from the types and the select list.
+    struct OutputCoercion {
+        struct Column {
+            unsigned index;
+            unsigned type; // SQL_xxx, without the nullable bit
+            unsigned length; // 0: default of the type, or the original length for text
+            int scale;
+        };
+
+        bool integersAsInt64 = false; // SMALLINT, INTEGER and NUMERIC as BIGINT, same scale
+        bool floatAsDouble = false;
+        bool charAsVarchar = false;
+        std::vector<Column> columns{}; // overrides the flags above
+
+        OutputCoercion& setColumn(unsigned index, unsigned type, unsigned length = 0, int scale = 0);
+        bool empty() const;
+    };
+    void setOutputCoercion(OutputCoercion coercion);
+    // current row as fetched, laid out by the (coerced) output metadata
+    const unsigned char* getRowBuffer() const;
+    unsigned getRowLength() const;
+
+    // execution plan, fetched once per prepared statement
+    const std::string& getPlan(bool detailed = false);
+
+    // run on the executor, serialized with the other calls on the same attachment;
+    // the statement must not be used until the result is ready
+    std::future<void> executeAsync(AsyncExecutor& executor);
+    std::future<void> openAsync(AsyncExecutor& executor);
+    std::future<size_t> fetchBlockAsync(AsyncExecutor& executor, ColumnBlock& block, size_t rows);
+#ifdef FB_WRAPPER_COROUTINES
+    AsyncExecutor::Awaitable<void> awaitExecute(AsyncExecutor& executor);
+    AsyncExecutor::Awaitable<void> awaitOpen(AsyncExecutor& executor);
+    AsyncExecutor::Awaitable<size_t> awaitFetchBlock(AsyncExecutor& executor, ColumnBlock& block, size_t rows);
+#endif
+
+    // typed rows: columns are checked once against the output metadata
+    template <typename Row>
+    void bindRow();
+    template <typename Row>
+    bool fetchInto(Row& row);
+    template <typename Row>
+    std::optional<Row> fetchInto();
+    template <typename Row>
+    RowRange<Row> rows();
+    // decodes the current row, e.g. after a positioning fetch
+    template <typename Row>
+    void readRow(Row& row);
+
+    // bulk DML through IBatch (Firebird 4)
+    void setBatchBufferSize(unsigned bytes);
+    void addRow();
+    // count input messages, each one getParametersAlignedLength() bytes apart
+    void addMessages(const void* messages, unsigned count);
+    unsigned getParametersAlignedLength();
+    BatchResult executeBatch();
+    void cancelBatch();
 private:
+    friend class BulkLoader;
+    friend class ResultExporter;
+
     void checkTransaction();
     void prepare();
     void initParametersByName();
-    void release();
+    void allocateBuffers(unsigned fieldsLength, unsigned parametersLength);
+    void releaseArena();
+    IMessageMetadata* coerceOutput();
+    void closeCursor();
+    void createBatch();
+    void flushBatch();
+    void releaseBatch();
+    template <typename StatusType>
+    void executeWith(StatusType* st);
+    void countExecute();
+    void countRows(size_t rows);
+    void checkScrollable();
+    bool fetched(int result);
+    size_t fillBlock(ColumnBlock& block, size_t rows, bool absolute, int position);
+    void capturePlan();
+    void checkSlowQuery(std::chrono::steady_clock::time_point start, uint64_t rows, const unsigned char* params);
+    const void* asyncKey() const;
+
+    // column of the bound row type: reader resolved by bindRow(), as
+    // ColumnReader<T>::Read of the member type
+    struct BoundColumn {
+        void (*read)();
+        unsigned offset;
+        unsigned nullOffset;
+        unsigned length;
+        int scale;
+    };
+
+    template <typename Row>
+    static const void* rowTag();
+    template <typename Row, size_t... I>
+    void checkRow(std::index_sequence<I...>);
+    template <typename Row, size_t... I>
+    void decodeRow(Row& row, std::index_sequence<I...>) const;
+    template <typename T>
+    T readColumn(const BoundColumn& c) const;
+    [[noreturn]] void throwNullColumn(const BoundColumn& c) const;
+    template <typename T>
+    void writeParameter(unsigned idx, const T& value);
+
+    std::pmr::memory_resource* memoryResource = std::pmr::get_default_resource();
+    unsigned char* arena = nullptr;
+    size_t arenaSize = 0;
 
     Parameter* parameters = nullptr;
-    std::unordered_map<std::string, unsigned int> namedParameters;
+    std::vector<std::pair<std::string, unsigned int> > namedParameters;
     unsigned int parametersCount = 0;
     unsigned char* parametersValueBuffer = nullptr;
+    unsigned int parametersBufferLength = 0;
 
     Field* fields = nullptr;
-    std::unordered_map<std::string, unsigned int> namedFields;
+    std::unordered_map<std::string_view, unsigned int> namedFields; // names owned by outMeta
     unsigned int fieldsCount = 0;
     unsigned char* fieldsValueBuffer = nullptr;
+    unsigned int fieldsBufferLength = 0;
     
+    std::string originalSql; // statement cache key
     std::string sql;
-    Transaction* transaction;
+    Transaction* transaction = nullptr;
+    Attachment* attachment = nullptr; // owner of stmt_
     IStatement* stmt_ = nullptr;
     ThrowStatusWrapper* status = nullptr;
     IResultSet* resSet_ = nullptr;
     IMessageMetadata* inMeta = nullptr;
     IMessageMetadata* outMeta = nullptr;
+    IMessageMetadata* rowMeta = nullptr; // layout of the fetched row: outMeta or its coerced copy
+    OutputCoercion coercion;
+    QueryMetrics* metrics = nullptr; // null while metrics are disabled
+
+    bool planCaptured = false;
+    std::string plan;
+    std::string detailedPlan;
 
+    // slow query log: the cursor is timed from open() to close()
+    bool cursorTimed = false;
+    std::chrono::steady_clock::time_point cursorStart;
+    uint64_t cursorRows = 0;
+    std::vector<unsigned char> cursorParameters; // parameters given to open()
+
+    bool scrollable = false;
     bool isPrepared = false;
+    const void* boundRow = nullptr; // row type checked by bindRow()
+    std::vector<BoundColumn> boundColumns;
+
+    IBatch* batch_ = nullptr;
+    unsigned int batchBufferSize = 8 * 1024 * 1024;
+    unsigned int batchPendingBytes = 0;
+    unsigned int batchPendingRows = 0;
+    BatchResult batchResult;
     
     EventDispatcher<DBStateEvents>::CBID transactionCallbackID;
 };
 
+#ifdef FB_WRAPPER_COROUTINES
+
+inline AsyncExecutor::Awaitable<void> Statement::awaitExecute(AsyncExecutor& executor) {
+    return executor.schedule(asyncKey(), [this] {
+        execute();
+    });
+}
+
+inline AsyncExecutor::Awaitable<void> Statement::awaitOpen(AsyncExecutor& executor) {
+    return executor.schedule(asyncKey(), [this] {
+        open();
+    });
+}
+
+inline AsyncExecutor::Awaitable<size_t> Statement::awaitFetchBlock(AsyncExecutor& executor, ColumnBlock& block, size_t rows) {
+    return executor.schedule(asyncKey(), [this, &block, rows] {
+        return fetchBlock(block, rows);
+    });
+}
+#endif
+
+template <typename Row>
+const void* Statement::rowTag() {
+    static const char tag = 0;
+    return &tag;
+}
+
+template <typename Row>
+void Statement::bindRow() {
+    checkTransaction();
+
+    if (!isPrepared)
+        prepare();
+
+    constexpr size_t n = RowAccess<Row>::size;
+    if (n != fieldsCount)
+        throw std::invalid_argument("Row binding: " + std::to_string(fieldsCount)
+            + " columns, " + std::to_string(n) + " expected!");
+
+    checkRow<Row>(std::make_index_sequence<n>());
+    boundRow = rowTag<Row>();
+}
+
+template <typename Row, size_t... I>
+void Statement::checkRow(std::index_sequence<I...>) {
+    void (* const readers[])() = {nullptr, reinterpret_cast<void (*)()>(ColumnReader<typename ColumnNull<
+            std::decay_t<decltype(RowAccess<Row>::template get<I>(std::declval<Row&>()))> >::Value>::select(
+            fields[I].type, fields[I].scale))...};
+
+    boundColumns.clear();
+    for (unsigned j = 0; j < fieldsCount; ++j) {
+        if (!readers[j + 1])
+            throw std::invalid_argument("Row binding: invalid data type for column " + std::to_string(j) + "!");
+
+        const Field& f = fields[j];
+        boundColumns.push_back(BoundColumn{readers[j + 1], f.offset, f.nullOffset, f.length, f.scale});
+    }
+}
+
+template <typename T>
+T Statement::readColumn(const BoundColumn& c) const {
+    if (*((const short*) (fieldsValueBuffer + c.nullOffset))) {
+        if constexpr (ColumnNull<T>::nullable)
+            return std::nullopt;
+        else
+            throwNullColumn(c);
+    }
+
+    typedef typename ColumnReader<typename ColumnNull<T>::Value>::Read Read;
+    return reinterpret_cast<Read>(c.read)(fieldsValueBuffer + c.offset, c.length, c.scale);
+}
+
+template <typename T>
+void Statement::writeParameter(unsigned idx, const T& value) {
+    typedef std::decay_t<T> D;
+    const Parameter& p = parameters[idx];
+
+    if (ParameterNull<D>::test(value)) {
+        *((short*) (parametersValueBuffer + p.nullOffset)) = 1;
+        return;
+    }
+
+    *((short*) (parametersValueBuffer + p.nullOffset)) = 0;
+    ParameterWriter<D>::write(parametersValueBuffer + p.offset, p.type, p.length, p.scale, value);
+}
+
+template <typename... Args>
+void Statement::bind(const Args&... args) {
+    if (!isPrepared) {
+        checkTransaction();
+        prepare();
+    }
+
+    if (sizeof...(Args) != parametersCount)
+        throw std::invalid_argument("Statement: " + std::to_string(parametersCount)
+            + " parameters, " + std::to_string(sizeof...(Args)) + " given!");
+
+    unsigned idx = 0;
+    (writeParameter(idx++, args), ...);
+}
+
+template <typename... Args>
+void Statement::open(const Args&... args) {
+    bind(args...);
+    open();
+}
+
+template <typename... Args>
+void Statement::execute(const Args&... args) {
+    bind(args...);
+    execute();
+}
+
+template <typename... Args>
+CallResult Statement::tryExecute(const Args&... args) {
+    bind(args...);
+    return tryExecute();
+}
+
+template <typename Row, size_t... I>
+void Statement::decodeRow(Row& row, std::index_sequence<I...>) const {
+    const BoundColumn* columns = boundColumns.data();
+    ((RowAccess<Row>::template get<I>(row) =
+            readColumn<std::decay_t<decltype(RowAccess<Row>::template get<I>(row))> >(columns[I])), ...);
+}
+
+template <typename Row>
+bool Statement::fetchInto(Row& row) {
+    if (boundRow != rowTag<Row>())
+        bindRow<Row>();
+
+    if (!fetch())
+        return false;
+
+    decodeRow(row, std::make_index_sequence<RowAccess<Row>::size>());
+    return true;
+}
+
+template <typename Row>
+void Statement::readRow(Row& row) {
+    if (boundRow != rowTag<Row>())
+        bindRow<Row>();
+
+    decodeRow(row, std::make_index_sequence<RowAccess<Row>::size>());
+}
+
+template <typename Row>
+std::optional<Row> Statement::fetchInto() {
+    Row row;
+
+    if (!fetchInto(row))
+        return std::nullopt;
+    return row;
+}
+
+template <typename Row>
+Statement::RowRange<Row> Statement::rows() {
+    return RowRange<Row>(this);
+}
+
 #endif /* STATEMENT_H */
 
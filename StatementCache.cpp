@@ -0,0 +1,103 @@
+/* 
+ * File:   StatementCache.cpp
+ * Created on 17 ottobre 2026
+ */
+
+#include <utility> // std::move
+#include "StatementCache.h"
+
+void StatementCache::Entry::release() {
+    if (stmt) {
+        stmt->release();
+        stmt = nullptr;
+    }
+
+    if (inMeta) {
+        inMeta->release();
+        inMeta = nullptr;
+    }
+
+    if (outMeta) {
+        outMeta->release();
+        outMeta = nullptr;
+    }
+}
+
+StatementCache::StatementCache(size_t capacity) : capacity(capacity) {
+}
+
+StatementCache::~StatementCache() {
+    clear();
+}
+
+void StatementCache::setCapacity(size_t capacity) {
+    this->capacity = capacity;
+    evict();
+}
+
+size_t StatementCache::getCapacity() const {
+    return capacity;
+}
+
+bool StatementCache::checkout(const std::string& key, Entry& entry) {
+    auto it = index.find(key);
+
+    if (it == index.end()) {
+        ++stats.misses;
+        return false;
+    }
+
+    ++stats.hits;
+    entry = std::move(it->second->second);
+    lru.erase(it->second);
+    index.erase(it);
+    return true;
+}
+
+void StatementCache::checkin(const std::string& key, Entry&& entry) {
+    if (!entry.stmt)
+        return;
+
+    // another statement with the same sql already gave back its handle
+    if (capacity == 0 || index.count(key)) {
+        ++stats.evictions;
+        entry.release();
+        return;
+    }
+
+    lru.emplace_front(key, std::move(entry));
+    index[key] = lru.begin();
+    entry.stmt = nullptr;
+    entry.inMeta = nullptr;
+    entry.outMeta = nullptr;
+
+    evict();
+}
+
+void StatementCache::clear() {
+    for (auto &it : lru)
+        it.second.release();
+
+    lru.clear();
+    index.clear();
+}
+
+StatementCache::Stats StatementCache::getStats() const {
+    Stats ret = stats;
+    ret.size = lru.size();
+    ret.capacity = capacity;
+    return ret;
+}
+
+void StatementCache::resetStats() {
+    stats = Stats();
+}
+
+void StatementCache::evict() {
+    while (lru.size() > capacity) {
+        index.erase(lru.back().first);
+        lru.back().second.release();
+        lru.pop_back();
+        ++stats.evictions;
+    }
+}
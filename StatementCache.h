@@ -0,0 +1,72 @@
+/* 
+ * File:   StatementCache.h
+ * Created on 17 ottobre 2026
+ */
+
+#ifndef STATEMENTCACHE_H
+#define STATEMENTCACHE_H
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "fb-wrapper.h"
+#include "Metrics.h"
+
+// LRU cache of prepared statements, keyed by the original SQL text.
+// Entries are checked out exclusively by a Statement and given back on reset.
+class StatementCache {
+public:
+    struct Entry {
+        std::string sql; // sql after named parameters rewriting
+        // few names per statement: a linear scan beats hashing and never allocates
+        std::vector<std::pair<std::string, unsigned int> > namedParameters;
+        unsigned int parametersCount = 0;
+        IStatement* stmt = nullptr;
+        IMessageMetadata* inMeta = nullptr;
+        IMessageMetadata* outMeta = nullptr;
+        QueryMetrics* metrics = nullptr; // owned by the MetricsRegistry
+        bool planCaptured = false;
+        std::string plan;
+        std::string detailedPlan;
+
+        void release();
+    };
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t size = 0;
+        size_t capacity = 0;
+    };
+
+    explicit StatementCache(size_t capacity = 32);
+    StatementCache(const StatementCache&) = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+    virtual ~StatementCache();
+
+    void setCapacity(size_t capacity);
+    size_t getCapacity() const;
+
+    bool checkout(const std::string& key, Entry& entry);
+    void checkin(const std::string& key, Entry&& entry);
+    void clear();
+
+    Stats getStats() const;
+    void resetStats();
+private:
+    void evict();
+
+    typedef std::list<std::pair<std::string, Entry> > LruList;
+
+    LruList lru; // most recently used first
+    std::unordered_map<std::string, LruList::iterator> index;
+    size_t capacity;
+    Stats stats;
+};
+
+#endif /* STATEMENTCACHE_H */
+
@@ -4,28 +4,34 @@
  */
 
 #include "Transaction.h"
+#include "Metrics.h"
 
 Transaction::Transaction() {
     status = new ThrowStatusWrapper(master->getStatus());
 }
 
 void Transaction::setAttachment(Attachment* attachemnt) {
+    if (this->attachment == attachemnt)
+        return;
+
     if (this->attachment) {
-        attachemnt->dispatcher.removeCallBack(attachmentCallbackID);
+        this->attachment->dispatcher.removeCallBack(attachmentCallbackID);
+        release();
+        // statements prepared on the previous attachment must drop their handles
+        dispatcher.broadcast(DBStateEvents::ATTACHMENT_DISCONNECT);
     }
 
-    release();
-
     this->attachment = attachemnt;
 
     attachmentCallbackID = attachemnt->dispatcher.addCallBack([this](DBStateEvents evt) {
         switch (evt) {
             case DBStateEvents::ATTACHMENT_DISCONNECT:
                 release();
+                dispatcher.broadcast(DBStateEvents::ATTACHMENT_DISCONNECT);
                 break;
             case DBStateEvents::ATTACHMENT_DELETE:
                 release();
-                dispatcher.broadcast(DBStateEvents::TRANSACTION_DISCONNECT);
+                dispatcher.broadcast(DBStateEvents::ATTACHMENT_DELETE);
                 this->attachment = nullptr;
                 break;
             default:
@@ -66,7 +72,8 @@ void Transaction::connect() {
     if (attachment) {
         if (!tra_) {
             attachment->connect();
-            tra_ = attachment->att_->startTransaction(status, 0, nullptr);
+            ScopedTimer timer(&MetricsRegistry::instance().transactionStart);
+            tra_ = attachment->att_->startTransaction(status, tpb.size(), tpb.data());
         }
     } else
         throw std::logic_error("Transaction: set attachment before connect!");
@@ -78,11 +85,31 @@ bool Transaction::isConnected() {
 }
 
 void Transaction::commit() {
-    if (tra_) {
-        tra_->commit(status);
-        tra_ = nullptr;
-        dispatcher.broadcast(DBStateEvents::TRANSACTION_DISCONNECT);
+    if (tra_)
+        commitWith(status);
+}
+
+CallResult Transaction::tryCommit() {
+    if (!tra_)
+        return CallResult();
+
+    CheckStatusWrapper* st = CallResult::status();
+    commitWith(st);
+    if (st->getState() & IStatus::STATE_ERRORS)
+        return CallResult(st->getErrors());
+    return CallResult();
+}
+
+template <typename StatusType>
+void Transaction::commitWith(StatusType* st) {
+    dispatcher.broadcast(DBStateEvents::TRANSACTION_DISCONNECT);
+    {
+        ScopedTimer timer(&MetricsRegistry::instance().commit);
+        tra_->commit(st);
     }
+    // a failed commit leaves the transaction active
+    if (!(st->getState() & IStatus::STATE_ERRORS))
+        tra_ = nullptr;
 }
 
 void Transaction::commitRetain() {
@@ -93,6 +120,7 @@ void Transaction::commitRetain() {
 void Transaction::rollback() {
     if (tra_) {
         dispatcher.broadcast(DBStateEvents::TRANSACTION_DISCONNECT);
+        ScopedTimer timer(&MetricsRegistry::instance().rollback);
         tra_->rollback(status);
         tra_ = nullptr;
     }
@@ -103,3 +131,144 @@ void Transaction::rollbackRetaining() {
         tra_->rollbackRetaining(status);
 }
 
+
+void Transaction::setOptions(const Options& options) {
+    // isc_tpb_at_snapshot_number only goes with isc_tpb_concurrency
+    if (options.atSnapshotNumber && options.isolation != Options::Isolation::SNAPSHOT)
+        throw std::invalid_argument("Transaction: a snapshot number needs the SNAPSHOT isolation!");
+
+    IXpbBuilder* builder = master->getUtilInterface()->getXpbBuilder(status, IXpbBuilder::TPB, NULL, 0);
+
+    try {
+        builder->insertTag(status, options.readOnly ? isc_tpb_read : isc_tpb_write);
+
+        switch (options.isolation) {
+            case Options::Isolation::SNAPSHOT:
+                builder->insertTag(status, isc_tpb_concurrency);
+                if (options.atSnapshotNumber)
+                    builder->insertBigInt(status, isc_tpb_at_snapshot_number, options.atSnapshotNumber);
+                break;
+            case Options::Isolation::SNAPSHOT_TABLE_STABILITY:
+                builder->insertTag(status, isc_tpb_consistency);
+                break;
+            case Options::Isolation::READ_COMMITTED:
+                builder->insertTag(status, isc_tpb_read_committed);
+                builder->insertTag(status, isc_tpb_rec_version);
+                break;
+            case Options::Isolation::READ_COMMITTED_NO_RECORD_VERSION:
+                builder->insertTag(status, isc_tpb_read_committed);
+                builder->insertTag(status, isc_tpb_no_rec_version);
+                break;
+            case Options::Isolation::READ_CONSISTENCY:
+                builder->insertTag(status, isc_tpb_read_committed);
+                builder->insertTag(status, isc_tpb_read_consistency);
+                break;
+        }
+
+        if (options.wait || options.lockTimeout) {
+            builder->insertTag(status, isc_tpb_wait);
+            if (options.lockTimeout)
+                builder->insertInt(status, isc_tpb_lock_timeout, options.lockTimeout);
+        } else
+            builder->insertTag(status, isc_tpb_nowait);
+
+        for (const auto &r : options.reservations) {
+            builder->insertString(status, r.write ? isc_tpb_lock_write : isc_tpb_lock_read, r.table.c_str());
+            switch (r.mode) {
+                case Options::Reservation::SHARED:
+                    builder->insertTag(status, isc_tpb_shared);
+                    break;
+                case Options::Reservation::PROTECTED:
+                    builder->insertTag(status, isc_tpb_protected);
+                    break;
+                case Options::Reservation::EXCLUSIVE:
+                    builder->insertTag(status, isc_tpb_exclusive);
+                    break;
+            }
+        }
+
+        const unsigned char* buffer = builder->getBuffer(status);
+        tpb.assign(buffer, buffer + builder->getBufferLength(status));
+    } catch (...) {
+        builder->dispose();
+        throw;
+    }
+    builder->dispose();
+}
+
+uint64_t Transaction::getSnapshotNumber() {
+    connect();
+
+    const unsigned char items[] = {isc_info_tra_snapshot_number, isc_info_end};
+    unsigned char buffer[32];
+    tra_->getInfo(status, sizeof (items), items, sizeof (buffer), buffer);
+
+    if (buffer[0] != isc_info_tra_snapshot_number)
+        throw std::runtime_error("Transaction: snapshot number not available!");
+
+    // little endian value of the given length
+    unsigned len = buffer[1] | (buffer[2] << 8);
+    uint64_t ret = 0;
+    for (unsigned i = 0; i < len && i < 8; ++i)
+        ret |= uint64_t(buffer[3 + i]) << (8 * i);
+
+    return ret;
+}
+
+bool Transaction::isConflict(const FbException& error) {
+    return isConflict(error.getStatus()->getErrors());
+}
+
+bool Transaction::isConflict(const ISC_STATUS* errors) {
+    const ISC_STATUS* s = errors;
+
+    while (*s != isc_arg_end) {
+        if (s[0] == isc_arg_gds) {
+            switch (s[1]) {
+                case isc_update_conflict:
+                case isc_deadlock:
+                case isc_lock_conflict:
+                case isc_lock_timeout:
+                case isc_concurrent_transaction:
+                    return true;
+                default:
+                    break;
+            }
+        }
+        s += s[0] == isc_arg_cstring ? 3 : 2;
+    }
+    return false;
+}
+
+/*********************************************************
+ * Options
+ */
+Transaction::Options& Transaction::Options::setReadOnly(bool readOnly) {
+    this->readOnly = readOnly;
+    return *this;
+}
+
+Transaction::Options& Transaction::Options::setIsolation(Isolation isolation) {
+    this->isolation = isolation;
+    return *this;
+}
+
+Transaction::Options& Transaction::Options::setWait(bool wait) {
+    this->wait = wait;
+    return *this;
+}
+
+Transaction::Options& Transaction::Options::setLockTimeout(unsigned seconds) {
+    lockTimeout = seconds;
+    return *this;
+}
+
+Transaction::Options& Transaction::Options::setAtSnapshotNumber(uint64_t snapshotNumber) {
+    atSnapshotNumber = snapshotNumber;
+    return *this;
+}
+
+Transaction::Options& Transaction::Options::reserveTable(std::string table, bool write, Reservation mode) {
+    reservations.push_back({std::move(table), write, mode});
+    return *this;
+}
@@ -6,32 +6,143 @@
 #ifndef TRANSACTION_H
 #define TRANSACTION_H
 
+#include <algorithm> // min
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
 #include "Attachment.h"
+#include "CallResult.h"
 
 // forward declaration
 class Statement;
 
 class Transaction {
     friend class Statement;
+    friend class Blob;
 public:
+    // transaction parameters, used by the next connect()
+    class Options {
+    public:
+        enum class Isolation {
+            SNAPSHOT, // concurrency
+            SNAPSHOT_TABLE_STABILITY, // consistency
+            READ_COMMITTED, // record_version
+            READ_COMMITTED_NO_RECORD_VERSION,
+            READ_CONSISTENCY // Firebird 4
+        };
+
+        enum class Reservation {
+            SHARED,
+            PROTECTED,
+            EXCLUSIVE
+        };
+
+        Options& setReadOnly(bool readOnly = true);
+        Options& setIsolation(Isolation isolation);
+        Options& setWait(bool wait = true);
+        // seconds, implies wait
+        Options& setLockTimeout(unsigned seconds);
+        Options& reserveTable(std::string table, bool write, Reservation mode = Reservation::SHARED);
+        // Firebird 4: share the snapshot of another transaction, see getSnapshotNumber();
+        // SNAPSHOT isolation only, setOptions() throws std::invalid_argument otherwise
+        Options& setAtSnapshotNumber(uint64_t snapshotNumber);
+    private:
+        friend class Transaction;
+
+        struct TableReservation {
+            std::string table;
+            bool write;
+            Reservation mode;
+        };
+
+        bool readOnly = false;
+        Isolation isolation = Isolation::SNAPSHOT;
+        bool wait = true;
+        unsigned lockTimeout = 0;
+        uint64_t atSnapshotNumber = 0;
+        std::vector<TableReservation> reservations;
+    };
+
+    // retries of runInTransaction(): exponential backoff with full jitter
+    struct RetryPolicy {
+        unsigned maxAttempts = 5;
+        std::chrono::milliseconds initialBackoff = std::chrono::milliseconds(10);
+        std::chrono::milliseconds maxBackoff = std::chrono::milliseconds(1000);
+    };
+
     Transaction();
     void setAttachment(Attachment* attachemnt);
     virtual ~Transaction();
     void commit();
+    // commit() without FbException: on failure the transaction stays active
+    CallResult tryCommit();
     void commitRetain();
     void connect();
     void rollback(); 
     void rollbackRetaining();
     bool isConnected();
+    void setOptions(const Options& options);
+    uint64_t getSnapshotNumber();
+
+    // runs fn(*this) in a new transaction and commits it; on update conflicts,
+    // deadlocks and lock timeouts the transaction is rolled back and retried.
+    // Throws std::logic_error when a transaction is already active: its work
+    // would be rolled back with the failed attempt.
+    template <typename F>
+    auto runInTransaction(F&& fn, const RetryPolicy& policy = RetryPolicy()) -> decltype(fn(*this));
+    static bool isConflict(const FbException& error);
+    static bool isConflict(const ISC_STATUS* errors);
     
     EventDispatcher<DBStateEvents> dispatcher; 
 private:
     void release();
-    Attachment* attachment;
+    template <typename StatusType>
+    void commitWith(StatusType* st);
+    Attachment* attachment = nullptr;
     ITransaction* tra_ = nullptr;
     ThrowStatusWrapper* status = nullptr;
+    std::vector<unsigned char> tpb;
     
     EventDispatcher<DBStateEvents>::CBID attachmentCallbackID;
 };
+
+template <typename F>
+auto Transaction::runInTransaction(F&& fn, const RetryPolicy& policy) -> decltype(fn(*this)) {
+    static thread_local std::minstd_rand random(std::random_device{}());
+
+    if (tra_)
+        throw std::logic_error("Transaction: commit or roll back before runInTransaction!");
+
+    std::chrono::milliseconds backoff = policy.initialBackoff;
+
+    for (unsigned attempt = 1;; ++attempt) {
+        try {
+            connect();
+            if constexpr (std::is_void<decltype(fn(*this))>::value) {
+                fn(*this);
+                commit();
+                return;
+            } else {
+                auto ret = fn(*this);
+                commit();
+                return ret;
+            }
+        } catch (const FbException& e) {
+            release();
+            if (attempt >= policy.maxAttempts || !isConflict(e))
+                throw;
+        } catch (...) {
+            release();
+            throw;
+        }
+
+        std::uniform_int_distribution<long> jitter(0, backoff.count());
+        std::this_thread::sleep_for(std::chrono::milliseconds(jitter(random)));
+        backoff = std::min(backoff * 2, policy.maxBackoff);
+    }
+}
+
 #endif /* TRANSACTION_H */
 
@@ -0,0 +1,84 @@
+/* 
+ * File:   batch.cpp
+ * Created on 17 ottobre 2026
+ *
+ * Rows per second of execute() per row against addRow()/executeBatch().
+ * usage: batch <server> <database> [rows]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include "../Attachment.h"
+#include "../Transaction.h"
+#include "../Statement.h"
+
+static double elapsed(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "usage: " << argv[0] << " <server> <database> [rows]" << std::endl;
+        return 1;
+    }
+    unsigned rows = argc > 3 ? std::atoi(argv[3]) : 100000;
+
+    Attachment attachment;
+    Transaction transaction;
+    Statement statement;
+
+    attachment.setParameter(argv[1], argv[2], "sysdba", "masterkey", "UTF8");
+    attachment.connect();
+    transaction.setAttachment(&attachment);
+    statement.setTransaction(&transaction);
+
+    statement.setSql("RECREATE TABLE BENCH_BATCH (ID INTEGER, DESC VARCHAR(20), VAL DOUBLE PRECISION, DATA BLOB)");
+    statement.execute();
+    transaction.commit();
+
+    statement.setSql("INSERT INTO BENCH_BATCH(ID, DESC, VAL) VALUES (?, ?, ?)");
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < rows; ++i) {
+        statement.parameter(0).setInt(i);
+        statement.parameter(1).setText("row");
+        statement.parameter(2).setDouble(i * 0.5);
+        statement.execute();
+    }
+    transaction.commit();
+    double t = elapsed(start);
+    std::cout << "execute per row: " << rows / t << " rows/s" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < rows; ++i) {
+        statement.parameter(0).setInt(i);
+        statement.parameter(1).setText("row");
+        statement.parameter(2).setDouble(i * 0.5);
+        statement.addRow();
+    }
+    Statement::BatchResult result = statement.executeBatch();
+    transaction.commit();
+    t = elapsed(start);
+    std::cout << "batch: " << rows / t << " rows/s, "
+            << result.affectedRecords << " inserted, "
+            << result.errors.size() << " errors" << std::endl;
+
+    const char data[256] = "blob";
+    statement.setSql("INSERT INTO BENCH_BATCH(ID, DATA) VALUES (?, ?)");
+    start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < rows; ++i) {
+        statement.parameter(0).setInt(i);
+        statement.parameter(1).setBlob(data, sizeof (data));
+        statement.addRow();
+    }
+    result = statement.executeBatch();
+    transaction.commit();
+    t = elapsed(start);
+    std::cout << "batch with blob: " << rows / t << " rows/s, "
+            << result.affectedRecords << " inserted, "
+            << result.errors.size() << " errors" << std::endl;
+
+    attachment.disconnect();
+
+    return 0;
+}
@@ -0,0 +1,192 @@
+/*
+ * File:   bench.cpp
+ * Created on 17 ottobre 2026
+ *
+ * Benchmark suite on a temporary database opened through the embedded engine.
+ * Every result is printed as one JSON object per line.
+ * usage: bench [rows]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <fcntl.h> // open
+#include <unistd.h> // getpid, close
+#include "../Attachment.h"
+#include "../Transaction.h"
+#include "../Statement.h"
+#include "../ResultExporter.h"
+
+#ifndef FB_WRAPPER_VERSION
+#define FB_WRAPPER_VERSION "unknown"
+#endif
+
+typedef std::chrono::steady_clock Clock;
+
+// runs fn once and reports ops operations
+static void report(const char* name, uint64_t ops, const std::function<void()>& fn) {
+    Clock::time_point start = Clock::now();
+    fn();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::cout << "{\"version\":\"" FB_WRAPPER_VERSION "\",\"benchmark\":\"" << name
+            << "\",\"operations\":" << ops
+            << ",\"seconds\":" << seconds
+            << ",\"ns_per_op\":" << seconds * 1e9 / ops
+            << ",\"ops_per_sec\":" << ops / seconds << "}" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    const unsigned rows = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const unsigned iterations = 1000;
+    std::string database = (std::filesystem::temp_directory_path()
+            / ("fb-wrapper-bench-" + std::to_string(getpid()) + ".fdb")).string();
+
+    try {
+        Attachment attachment;
+        Transaction transaction;
+        Statement statement;
+
+        attachment.createDatabase("", database, "sysdba", "masterkey", "UTF8");
+        transaction.setAttachment(&attachment);
+        statement.setTransaction(&transaction);
+
+        statement.setSql("CREATE TABLE BENCH (ID INTEGER PRIMARY KEY, SMALL SMALLINT, BIG BIGINT, "
+                "VAL DOUBLE PRECISION, NAME VARCHAR(40), CODE CHAR(10), DAY DATE)");
+        statement.execute();
+        transaction.commit();
+
+        // prepare latency, with and without the statement cache
+        attachment.setStatementCacheSize(0);
+        report("prepare", iterations, [&] {
+            for (unsigned i = 0; i < iterations; ++i) {
+                statement.setSql(i % 2 ? "SELECT * FROM BENCH WHERE ID = ?" : "SELECT ID FROM BENCH WHERE ID = ?");
+                statement.parameter(0);
+            }
+        });
+        attachment.setStatementCacheSize(32);
+        report("prepare_cached", iterations, [&] {
+            for (unsigned i = 0; i < iterations; ++i) {
+                statement.setSql(i % 2 ? "SELECT * FROM BENCH WHERE ID = ?" : "SELECT ID FROM BENCH WHERE ID = ?");
+                statement.parameter(0);
+            }
+        });
+
+        // single row insert
+        statement.setSql("INSERT INTO BENCH VALUES (?, ?, ?, ?, ?, ?, CURRENT_DATE)");
+        report("insert_row", rows, [&] {
+            for (unsigned i = 0; i < rows; ++i) {
+                statement.parameter(0).setInt(i);
+                statement.parameter(1).setInt(i % 1000);
+                statement.parameter(2).setInt(uint64_t(i) * 1000003);
+                statement.parameter(3).setDouble(i * 0.25);
+                statement.parameter(4).setText("benchmark row name");
+                statement.parameter(5).setText("CODE");
+                statement.execute();
+            }
+        });
+        transaction.commit();
+
+        // fetch and decode per column type
+        statement.setSql("SELECT ID, SMALL, BIG, VAL, NAME, CODE, DAY FROM BENCH");
+        const char* columns[] = {"fetch_integer", "fetch_smallint", "fetch_bigint", "fetch_double",
+            "fetch_varchar", "fetch_char", "fetch_date"};
+        for (unsigned c = 0; c < 7; ++c) {
+            statement.open();
+            Statement::Field f = statement.field(c);
+            int64_t sum = 0;
+            report(columns[c], rows, [&] {
+                while (statement.fetch()) {
+                    switch (c) {
+                        case 3:
+                            sum += (int64_t) f.asDouble();
+                            break;
+                        case 4:
+                        case 5:
+                            sum += f.asString().size();
+                            break;
+                        case 6:
+                            sum += f.formatDate().size();
+                            break;
+                        default:
+                            sum += f.asInteger();
+                            break;
+                    }
+                }
+            });
+            statement.close();
+        }
+
+        statement.open();
+        report("fetch_only", rows, [&] {
+            while (statement.fetch())
+                ;
+        });
+        statement.close();
+
+        ColumnBlock block;
+        statement.open();
+        report("fetch_block", rows, [&] {
+            while (statement.fetchBlock(block, 4096))
+                ;
+        });
+        statement.close();
+
+        // export to /dev/null
+        int devNull = open("/dev/null", O_WRONLY);
+        ResultExporter::Options jsonl;
+        jsonl.format = ResultExporter::Format::JSONL;
+        statement.open();
+        report("export_csv", rows, [&] {
+            ResultExporter().write(statement, devNull);
+        });
+        statement.close();
+        statement.open();
+        report("export_jsonl", rows, [&] {
+            ResultExporter(jsonl).write(statement, devNull);
+        });
+        statement.close();
+        close(devNull);
+
+        // field access by name, by index and through a resolved handle
+        statement.open();
+        statement.fetch();
+        const unsigned accesses = 1000000;
+        int64_t sum = 0;
+        report("field_by_name", accesses, [&] {
+            for (unsigned i = 0; i < accesses; ++i)
+                sum += statement.fieldByName("BIG").asInteger();
+        });
+        report("field_by_index", accesses, [&] {
+            for (unsigned i = 0; i < accesses; ++i)
+                sum += statement.field(2).asInteger();
+        });
+        Statement::Field big = statement.resolveField("BIG");
+        report("field_resolved", accesses, [&] {
+            for (unsigned i = 0; i < accesses; ++i)
+                sum += big.asInteger();
+        });
+        statement.close();
+        transaction.commit();
+
+        // transaction start and commit
+        report("transaction", iterations, [&] {
+            for (unsigned i = 0; i < iterations; ++i) {
+                transaction.connect();
+                transaction.commit();
+            }
+        });
+
+        attachment.dropDatabase();
+    } catch (const FbException& e) {
+        char buf[256];
+        formatExceptionMessage(e, buf, 256);
+        std::cerr << buf << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,70 @@
+/* 
+ * File:   blob.cpp
+ * Created on 17 ottobre 2026
+ *
+ * Blob write and read throughput for different segment sizes.
+ * usage: blob <server> <database> [megabytes]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "../Attachment.h"
+#include "../Transaction.h"
+#include "../Statement.h"
+#include "../Blob.h"
+
+static double elapsed(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "usage: " << argv[0] << " <server> <database> [megabytes]" << std::endl;
+        return 1;
+    }
+    unsigned megabytes = argc > 3 ? std::atoi(argv[3]) : 64;
+    const uint64_t size = uint64_t(megabytes) * 1024 * 1024;
+
+    Attachment attachment;
+    Transaction transaction;
+    Blob blob;
+
+    attachment.setParameter(argv[1], argv[2], "sysdba", "masterkey", "UTF8");
+    attachment.connect();
+    transaction.setAttachment(&attachment);
+    blob.setTransaction(&transaction);
+
+    const unsigned segmentSizes[] = {4096, 16384, 32768, 65535};
+    std::vector<unsigned char> data(65535, 'x');
+
+    for (unsigned segmentSize : segmentSizes) {
+        blob.setSegmentSize(segmentSize);
+
+        auto start = std::chrono::steady_clock::now();
+        blob.create();
+        for (uint64_t written = 0; written < size; written += segmentSize)
+            blob.write(data.data(), segmentSize);
+        blob.close();
+        double tw = elapsed(start);
+
+        start = std::chrono::steady_clock::now();
+        blob.open(blob.getId());
+        uint64_t total = 0;
+        unsigned n;
+        while ((n = blob.read(data.data(), segmentSize)) > 0)
+            total += n;
+        blob.close();
+        double tr = elapsed(start);
+
+        std::cout << "segment " << segmentSize << ": write "
+                << size / tw / (1024 * 1024) << " MB/s, read "
+                << total / tr / (1024 * 1024) << " MB/s" << std::endl;
+    }
+
+    transaction.rollback();
+    attachment.disconnect();
+
+    return 0;
+}
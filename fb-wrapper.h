@@ -29,6 +29,8 @@ namespace Firebird {
     class IXpbBuilder;
     class FbException;
     class IMessageMetadata;
+    class IBatch;
+    class IBlob;
 }
 
 using namespace Firebird;
@@ -1,68 +1,809 @@
-/* 
+/*
  * File:   test.cpp
+ *
+ * usage: test [database]
+ * Without arguments a temporary database is created through the embedded
+ * engine and dropped at the end.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <string>
+#include <thread>
+#include <unistd.h> // getpid
 #include "Attachment.h"
 #include "Transaction.h"
 #include "Statement.h"
+#include "Blob.h"
+#include "BulkLoader.h"
+#include "PageReader.h"
+#include "ParallelScan.h"
+#include "ResultExporter.h"
+#include "EventSubscription.h"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    if (!(cond)) { \
+        std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #cond << std::endl; \
+        ++failures; \
+    }
+
+struct Item {
+    int64_t id;
+    std::string desc;
+    std::optional<double> val;
+};
+
+template <> struct RowTraits<Item> {
+    static constexpr auto fields = std::make_tuple(&Item::id, &Item::desc, &Item::val);
+};
+
+#ifdef FB_WRAPPER_COROUTINES
+
+// fire and forget coroutine, enough to drive the awaitables
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() {
+            return {};
+        }
+
+        std::suspend_never initial_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_never final_suspend() noexcept {
+            return {};
+        }
 
-#define SERVER ...
-#define DATABASE ...
+        void return_void() {
+        }
+
+        void unhandled_exception() {
+            std::terminate();
+        }
+    };
+};
+
+static Detached awaitSum(AsyncExecutor& executor, std::promise<int>& done) {
+    int a = co_await executor.schedule(&executor, [] {
+        return 1;
+    });
+    int b = co_await executor.schedule(&executor, [] {
+        return 2;
+    });
+    try {
+        co_await executor.schedule(nullptr, [] {
+            throw std::runtime_error("failed");
+        });
+    } catch (const std::runtime_error&) {
+        b += 10;
+    }
+    done.set_value(a + b);
+}
+#endif
+
+// drops the test database when a failure leaves it behind; errors while
+// cleaning up go to stderr and do not replace the one being reported
+struct DropDatabase {
+    Attachment& attachment;
+    Transaction& transaction;
+
+    ~DropDatabase() {
+        if (!attachment.isConnected())
+            return;
+        try {
+            // an open transaction would keep the database in use
+            transaction.rollback();
+            attachment.dropDatabase();
+        } catch (const FbException& e) {
+            char buf[256];
+            formatExceptionMessage(e, buf, 256);
+            std::cerr << buf << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+};
 
 /*
- * 
+ *
  */
-int main() {
-    Attachment attachment;
-    Transaction transaction;
-    Statement statement;
-    
-    attachment.createDatabase(SERVER, DATABASE, "sysdba", "masterkey", "UTF8");
-    attachment.connect();
-    
-    transaction.setAttachment(&attachment);
-    
-    statement.setSql("CREATE TABLE TEST (ID INTEGER PRIMARY KEY, DESC VARCHAR(10))");
-    statement.setTransaction(&transaction);
-    statement.execute();
-    transaction.commitRetain();
-    
-
-    statement.setSql("INSERT INTO TEST(ID, DESC) VALUES (1, 'AAA')");
-    statement.execute();
-    statement.setSql("INSERT INTO TEST(ID, DESC) VALUES (2, 'BBB')");
-    statement.execute();
-    statement.setSql("INSERT INTO TEST(ID, DESC) VALUES (3, 'CCC')");
-    statement.execute();
-    statement.setSql("INSERT INTO TEST(ID, DESC) VALUES (4, 'DDD')");
-    statement.execute();
-    statement.setSql("INSERT INTO TEST(ID, DESC) VALUES (5, 'EEE')");
-    statement.execute();
-    transaction.commitRetain();
-
-    statement.setSql("SELECT * FROM TEST WHERE ID >= :ID");
-    statement.paramByName("ID").setInt(3);
-    statement.open();
-    while(statement.fetch()){
-        std::cout << "ID: " << statement.fieldByName("ID").asInteger();
-        std::cout << " DESC: " << statement.fieldByName("DESC").asString() << std::endl;
+int main(int argc, char** argv) {
+    std::string database = argc > 1 ? argv[1] :
+            (std::filesystem::temp_directory_path() / ("fb-wrapper-test-" + std::to_string(getpid()) + ".fdb")).string();
+
+    // async executor
+    {
+        AsyncExecutor executor(4, 8);
+        int key;
+        std::vector<int> order;
+        std::vector<std::future<int> > results;
+        for (int j = 0; j < 100; ++j) {
+            results.push_back(executor.submit(&key, [&order, j] {
+                order.push_back(j);
+                return j;
+            }));
+        }
+        for (int j = 0; j < 100; ++j)
+            CHECK(results[j].get() == j);
+        CHECK(order.size() == 100 && std::is_sorted(order.begin(), order.end()));
+
+        std::future<void> failed = executor.submit(nullptr, [] {
+            throw std::runtime_error("failed");
+        });
+        try {
+            failed.get();
+            CHECK(!"exception lost");
+        } catch (const std::runtime_error&) {
+        }
+
+#ifdef FB_WRAPPER_COROUTINES
+        std::promise<int> sum;
+        awaitSum(executor, sum);
+        CHECK(sum.get_future().get() == 13);
+#endif
     }
-    statement.close();
-    
-    std::cout << std::endl;
-    
-    statement.setSql("SELECT * FROM TEST WHERE ID <= ?");
-    statement.parameter(0).setInt(2);
-    statement.open();
-    while(statement.fetch()){
-        std::cout << "ID: " << statement.field(0).asInteger();
-        std::cout << " DESC: " << statement.field(1).asString() << std::endl;
+
+    // a task blocked on a full queue is released by the destructor
+    {
+        std::promise<void> posted;
+        std::atomic<bool> ran{false};
+        std::atomic<bool> refused{false};
+        {
+            AsyncExecutor executor(1, 1);
+            executor.post(nullptr, [&] {
+                executor.post(nullptr, [&] {
+                    ran = true;
+                });
+                posted.set_value();
+                try {
+                    executor.post(nullptr, [] {
+                    });
+                } catch (const std::logic_error&) {
+                    refused = true;
+                }
+            });
+            posted.get_future().wait();
+        }
+        CHECK(ran && refused);
     }
-    statement.close();
-    
-    attachment.disconnect();
-    
-    return 0;
-}
 
+    try {
+        MetricsRegistry::setEnabled(true);
+
+        Attachment attachment;
+        Transaction transaction;
+        Statement statement;
+        DropDatabase cleanup{attachment, transaction};
+
+        attachment.createDatabase("", database, "sysdba", "masterkey", "UTF8");
+        attachment.connect();
+
+        transaction.setAttachment(&attachment);
+
+        statement.setSql("CREATE TABLE TEST (ID INTEGER PRIMARY KEY, DESC VARCHAR(10), VAL DOUBLE PRECISION, DATA BLOB)");
+        statement.setTransaction(&transaction);
+        statement.execute();
+        transaction.commitRetain();
+
+        statement.setSql("INSERT INTO TEST(ID, DESC, VAL) VALUES (1, 'AAA', 1.5)");
+        statement.execute();
+        statement.setSql("INSERT INTO TEST(ID, DESC, VAL) VALUES (2, 'BBB', 2.5)");
+        statement.execute();
+        statement.setSql("INSERT INTO TEST(ID, DESC, VAL) VALUES (3, 'CCC', 3.5)");
+        statement.execute();
+        statement.setSql("INSERT INTO TEST(ID, DESC, VAL) VALUES (4, 'DDD', 4.5)");
+        statement.execute();
+        // variadic binding
+        statement.setSql("INSERT INTO TEST(ID, DESC, VAL) VALUES (?, ?, ?)");
+        bool tooLong = false;
+        try {
+            statement.execute(5, std::string_view("EEEEEEEEEEE"), std::nullopt);
+        } catch (const std::out_of_range&) {
+            tooLong = true;
+        }
+        CHECK(tooLong);
+        statement.execute(5, std::string_view("EEE"), std::nullopt);
+        transaction.commit();
+
+        // named parameters
+        statement.setSql("SELECT * FROM TEST WHERE ID >= :ID ORDER BY ID");
+        statement.paramByName("ID").setInt(3);
+        statement.open();
+        Statement::Field id = statement.resolveField("ID");
+        Statement::Field desc = statement.resolveField("DESC");
+        int rows = 0;
+        while(statement.fetch()){
+            CHECK(id.asInteger() == 3 + rows);
+            CHECK(desc.asStringView().size() == 3);
+            ++rows;
+        }
+        statement.close();
+        CHECK(rows == 3);
+
+        // positional parameters, statement kept across commit
+        statement.setSql("SELECT * FROM TEST WHERE ID <= ? ORDER BY ID");
+        statement.parameter(0).setInt(2);
+        statement.open();
+        CHECK(statement.fetch());
+        CHECK(statement.field(0).asInteger() == 1);
+        CHECK(statement.field(1).asString() == "AAA");
+        CHECK(statement.field(2).asDouble() == 1.5);
+        statement.close();
+        transaction.commit();
+
+        statement.open();
+        rows = 0;
+        while (statement.fetch())
+            ++rows;
+        statement.close();
+        CHECK(rows == 2);
+
+        // statement cache
+        StatementCache::Stats before = attachment.getStatementCacheStats();
+        statement.setSql("SELECT * FROM TEST WHERE ID >= :ID ORDER BY ID");
+        statement.paramByName("ID").setInt(1);
+        CHECK(attachment.getStatementCacheStats().hits == before.hits + 1);
+
+        // typed rows
+        statement.open();
+        rows = 0;
+        for (const Item& item : statement.rows<Item>()) {
+            CHECK(item.id == rows + 1);
+            CHECK(item.val.has_value() == (item.id != 5));
+            ++rows;
+        }
+        statement.close();
+        CHECK(rows == 5);
+        statement.setSql("SELECT VAL FROM TEST WHERE ID = 5");
+        statement.open();
+        try {
+            statement.fetchInto<std::tuple<double> >();
+            CHECK(!"NULL read into double");
+        } catch (const std::invalid_argument&) {
+        }
+        statement.close();
+        statement.setSql("SELECT * FROM TEST WHERE ID >= :ID ORDER BY ID");
+        statement.paramByName("ID").setInt(1);
+
+        // block fetch
+        ColumnBlock block;
+        statement.open();
+        CHECK(statement.fetchBlock(block, 10) == 5);
+        CHECK(block.column(0).integers[4] == 5);
+        CHECK(block.column(1).stringLength(0) == 3);
+        CHECK(block.column(2).isNull(4));
+        statement.close();
+
+        // scrollable cursor and pages
+        statement.setSql("SELECT * FROM TEST ORDER BY ID");
+        statement.setScrollable(true);
+        statement.open();
+        CHECK(statement.fetchLast() && statement.field(0).asInteger() == 5);
+        CHECK(statement.fetchPrior() && statement.field(0).asInteger() == 4);
+        CHECK(statement.fetchAbsolute(2) && statement.field(0).asInteger() == 2);
+        CHECK(statement.fetchRelative(2) && statement.field(0).asInteger() == 4);
+        CHECK(statement.fetchFirst() && statement.field(0).asInteger() == 1);
+        CHECK(!statement.fetchAbsolute(6));
+
+        PageReader pages(statement, 2);
+        std::vector<Item> items;
+        CHECK(pages.read(2, items) == 1 && items[0].id == 5);
+        CHECK(pages.read(0, items) == 2 && items[1].id == 2);
+        CHECK(pages.read(1, block) == 2 && block.column(0).integers[0] == 3);
+        CHECK(pages.read(3, block) == 0);
+        statement.close();
+        statement.setScrollable(false);
+
+        // output coerced by the server: ID as BIGINT, VAL as NUMERIC(18,2)
+        Statement coerced;
+        coerced.setTransaction(&transaction);
+        coerced.setOutputCoercion(Statement::OutputCoercion().setColumn(1, SQL_INT64, 0, -2));
+        coerced.setSql("SELECT ID, VAL FROM TEST WHERE ID = 1");
+        coerced.open();
+        CHECK(coerced.fetch());
+        CHECK(coerced.field(0).type == SQL_LONG && coerced.field(1).type == SQL_INT64);
+        CHECK(coerced.field(1).asDecimal() == Decimal(150, -2) && coerced.field(1).asInteger() == 1);
+        coerced.close();
+        coerced.setOutputCoercion(Statement::OutputCoercion{true});
+        coerced.open();
+        CHECK(coerced.fetch() && coerced.field(0).type == SQL_INT64);
+        CHECK(*(const ISC_INT64*) (coerced.getRowBuffer() + coerced.field(0).offset) == 1);
+        coerced.close();
+
+        // exact numerics
+        statement.setSql("SELECT CAST(? AS NUMERIC(9,2)), CAST(12345678901234567890.12 AS NUMERIC(38,2)),"
+                " CAST(0.1 AS DECFLOAT(16)) FROM RDB$DATABASE");
+        statement.open(Decimal::parse("-3.14"));
+        CHECK(statement.fetch());
+        CHECK(statement.field(0).asDecimal() == Decimal(-314, -2));
+        CHECK(statement.field(0).asString() == "-3.14" && statement.field(0).asInteger() == -3);
+        CHECK(statement.field(1).asString() == "12345678901234567890.12");
+        CHECK(statement.field(2).asDecimal() == Decimal(1, -1));
+        statement.close();
+
+        // typed rows on a scaled column: integers are written scaled, read as Decimal
+        statement.setSql("CREATE TABLE AMOUNTS (ID INTEGER, AMOUNT NUMERIC(18,2))");
+        statement.execute();
+        transaction.commitRetain();
+        statement.setSql("INSERT INTO AMOUNTS (ID, AMOUNT) VALUES (?, ?)");
+        statement.execute(1, 3);
+        statement.execute(2, Decimal::parse("-0.05"));
+        statement.setSql("SELECT ID, AMOUNT FROM AMOUNTS ORDER BY ID");
+        try {
+            statement.bindRow<std::tuple<int64_t, int64_t> >();
+            CHECK(!"scaled column bound to int64_t");
+        } catch (const std::invalid_argument&) {
+        }
+        statement.open();
+        std::optional<std::tuple<int64_t, Decimal> > amount = statement.fetchInto<std::tuple<int64_t, Decimal> >();
+        CHECK(amount && std::get<1>(*amount) == Decimal(300, -2));
+        CHECK(statement.field(1).asInteger() == 3);
+        amount = statement.fetchInto<std::tuple<int64_t, Decimal> >();
+        CHECK(amount && std::get<1>(*amount).toString() == "-0.05");
+        statement.close();
+
+        // dates and times
+        statement.setSql("SELECT CAST('2026-10-17 12:34:56.7890' AS TIMESTAMP), CAST(? AS DATE),"
+                " CAST(NULL AS DATE), CAST('12:34:56' AS TIME) FROM RDB$DATABASE");
+        statement.open(DateTime::timePoint(86400000000LL + 1));
+        CHECK(statement.fetch());
+        CHECK(statement.field(0).asIsoString() == "2026-10-17T12:34:56.7890");
+        CHECK(statement.field(0).asEpochMicros() % 1000000 == 789000);
+        CHECK(statement.field(0).formatDate("%d/%m/%Y %H:%M") == "17/10/2026 12:34");
+        CHECK(statement.field(1).asTimestamp() == DateTime::timePoint(86400000000LL));
+        CHECK(statement.field(1).formatDate() == "1970-01-02");
+        CHECK(statement.field(2).formatDate().empty());
+        CHECK(statement.field(3).formatDate().empty() && statement.field(3).formatDate("%H:%M") == "12:34");
+        statement.close();
+
+        // export
+        std::string out;
+        ResultExporter::Sink append = [&out](const char* data, size_t length) {
+            out.append(data, length);
+        };
+        statement.setSql("SELECT ID, DESC, VAL FROM TEST WHERE ID IN (1, 5) ORDER BY ID");
+        statement.open();
+        CHECK(ResultExporter().write(statement, append) == 2);
+        statement.close();
+        CHECK(out == "ID,DESC,VAL\n1,AAA,1.5\n5,EEE,\n");
+
+        out.clear();
+        ResultExporter::Options jsonl;
+        jsonl.format = ResultExporter::Format::JSONL;
+        statement.open();
+        ResultExporter(jsonl).write(statement, append);
+        statement.close();
+        CHECK(out == "{\"ID\":1,\"DESC\":\"AAA\",\"VAL\":1.5}\n{\"ID\":5,\"DESC\":\"EEE\",\"VAL\":null}\n");
+
+        // statement buffers from a caller supplied memory resource
+        std::pmr::unsynchronized_pool_resource pool;
+        Statement pooled;
+        pooled.setMemoryResource(&pool);
+        pooled.setTransaction(&transaction);
+        pooled.setSql("SELECT DESC FROM TEST WHERE ID = ?");
+        pooled.parameter(0).setInt(2);
+        pooled.open();
+        CHECK(pooled.fetch() && pooled.field(0).asString() == "BBB");
+        pooled.close();
+        pooled.setSql("SELECT ID, DESC, VAL FROM TEST WHERE ID = ?");
+        pooled.parameter(0).setInt(3);
+        pooled.open();
+        CHECK(pooled.fetch() && pooled.field(2).asDouble() == 3.5);
+        pooled.close();
+
+        // blob
+        const char text[] = "blob content";
+        Blob blob;
+        blob.setTransaction(&transaction);
+        blob.create();
+        blob.write(text, sizeof (text));
+        blob.close();
+
+        statement.setSql("UPDATE TEST SET DATA = ? WHERE ID = 1");
+        statement.parameter(0).setBlobId(blob.getId());
+        statement.execute();
+
+        statement.setSql("SELECT DATA FROM TEST WHERE ID = 1");
+        statement.open();
+        CHECK(statement.fetch());
+        char buf[64] = {0};
+        blob.open(statement.field(0).asBlobId());
+        CHECK(blob.read(buf, sizeof (buf)) == sizeof (text));
+        CHECK(std::string(buf) == text);
+        blob.close();
+        statement.close();
+        transaction.commit();
+
+        // metrics
+        MetricsSnapshot snapshot = MetricsRegistry::instance().snapshot();
+        bool found = false;
+        for (const auto &s : snapshot.statements) {
+            if (s.sql == "SELECT * FROM TEST WHERE ID >= ? ORDER BY ID") {
+                found = true;
+                CHECK(s.executes == 3);
+                CHECK(s.rowsFetched == 3 + 5 + 5);
+            }
+        }
+        CHECK(found);
+        CHECK(snapshot.commit.count >= 3);
+        CHECK(snapshot.toPrometheus().find("fbwrapper_statement_rows_fetched_total") != std::string::npos);
+        // fixed boundaries, the empty ones included
+        CHECK(snapshot.toPrometheus().find("operation=\"prepare\",le=\"2199.02326\"}") != std::string::npos);
+
+        // slow query log: with a 1 ns threshold every statement is slow
+        std::vector<SlowQueryLog::Record> slow;
+        SlowQueryLog::instance().setSink([&slow](const SlowQueryLog::Record& r) {
+            slow.push_back(r);
+        });
+        SlowQueryLog::instance().setThreshold(std::chrono::nanoseconds(1));
+        statement.setSql("SELECT * FROM TEST WHERE ID >= :ID ORDER BY ID");
+        statement.paramByName("ID").setInt(4);
+        statement.open();
+        while (statement.fetch())
+            ;
+        statement.close();
+        SlowQueryLog::instance().setThreshold(std::chrono::nanoseconds(0));
+        SlowQueryLog::instance().flush();
+        SlowQueryLog::instance().setSink(nullptr);
+        CHECK(slow.size() == 1);
+        if (!slow.empty()) {
+            CHECK(slow[0].rowsFetched == 2);
+            CHECK(slow[0].parameters.size() == 1 && slow[0].parameters[0] == "4");
+            CHECK(slow[0].plan.find("PLAN") != std::string::npos);
+        }
+        transaction.commit();
+
+        // attachment pool
+        {
+            AttachmentPool::Options options;
+            options.minSize = 1;
+            options.maxSize = 2;
+            options.idleTimeout = std::chrono::milliseconds(50);
+            AttachmentPool connections("", database, "sysdba", "masterkey", "UTF8", options);
+            CHECK(connections.getMetrics().idle == 1);
+            {
+                AttachmentPool::Lease a = connections.acquire();
+                AttachmentPool::Lease b = connections.acquire();
+                CHECK(a && b && a.get() != b.get() && a->isConnected());
+                CHECK(connections.getMetrics().active == 2 && connections.getMetrics().idle == 0);
+
+                // exhausted: a timed checkout gives up, a blocking one waits for a lease back
+                CHECK(!connections.acquire(std::chrono::milliseconds(20)));
+                std::thread giver([&a] {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                    a.release();
+                });
+                AttachmentPool::Lease c = connections.acquire();
+                giver.join();
+                CHECK(c && c->isConnected());
+            }
+            AttachmentPool::Metrics m = connections.getMetrics();
+            CHECK(m.active == 0 && m.idle == 2 && m.created == 2);
+            CHECK(m.checkouts == 3 && m.timeouts == 1);
+
+            // past the idle timeout: closed down to minSize
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            connections.evictIdle();
+            m = connections.getMetrics();
+            CHECK(m.idle == 1 && m.destroyed == 1);
+        }
+
+        // batch: flushes on the way, blobs in the stream, a failing row
+        {
+            statement.setSql("CREATE TABLE BATCHED (ID INTEGER PRIMARY KEY, NAME VARCHAR(10), DATA BLOB)");
+            statement.execute();
+            transaction.commitRetain();
+
+            Statement batch;
+            batch.setTransaction(&transaction);
+            batch.setSql("INSERT INTO BATCHED (ID, NAME, DATA) VALUES (?, ?, ?)");
+            batch.setBatchBufferSize(1024);
+            const char data[] = "batch blob";
+            for (int j = 1; j <= 50; ++j) {
+                batch.parameter(0).setInt(j == 50 ? 1 : j);
+                batch.parameter(1).setText("ROW");
+                if (j % 2)
+                    batch.parameter(2).setBlob(data, sizeof (data) - 1);
+                else
+                    batch.parameter(2).setNull();
+                batch.addRow();
+            }
+            Statement::BatchResult result = batch.executeBatch();
+            CHECK(result.states.size() == 50 && result.affectedRecords == 49);
+            CHECK(result.states.size() == 50 && result.states[49] == Statement::BATCH_EXECUTE_FAILED);
+            CHECK(result.errors.size() == 1 && result.errors[0].first == 49);
+
+            batch.parameter(0).setInt(100);
+            batch.parameter(1).setText("CANCELLED");
+            batch.parameter(2).setNull();
+            batch.addRow();
+            batch.cancelBatch();
+            CHECK(batch.executeBatch().states.empty());
+
+            statement.setSql("SELECT COUNT(*), COUNT(DATA), MAX(ID) FROM BATCHED");
+            statement.open();
+            CHECK(statement.fetch() && statement.field(0).asInteger() == 49);
+            CHECK(statement.field(1).asInteger() == 25 && statement.field(2).asInteger() == 49);
+            statement.close();
+            statement.setSql("SELECT CAST(DATA AS VARCHAR(20)) FROM BATCHED WHERE ID = 47");
+            statement.open();
+            CHECK(statement.fetch() && statement.field(0).asString() == data);
+            statement.close();
+            transaction.commit();
+        }
+
+        // bulk load: quoted fields, chunks split inside a quoted new line, rejects
+        {
+            statement.setSql("CREATE TABLE LOADED (ID INTEGER, NAME VARCHAR(20), AMOUNT NUMERIC(9,2), D DATE, T TIME)");
+            statement.execute();
+            transaction.commit();
+
+            std::string csv = (std::filesystem::temp_directory_path()
+                    / ("fb-wrapper-test-" + std::to_string(getpid()) + ".csv")).string();
+            std::ofstream(csv) << "ID,NAME,AMOUNT,D,T\n"
+                    "1,plain,1.5,2026-10-17,12:34:56.789\n"
+                    "2,\"with, comma\",-0.25,2000-02-29,00:00\r\n"
+                    "3,\"say \"\"hi\"\"\",7,1999-12-31,23:59:59\n"
+                    "4,\"two\nlines\",.01,2026-01-01,01:02\n"
+                    "5,bad,1.2.3,2026-01-01,01:02\n"
+                    "6,frac,1.234,2026-01-01,01:02\n"
+                    "7,date,1,2026-02-30,01:02\n"
+                    "8,time,1,2026-01-01,24:00\n"
+                    "9,short,1\n"
+                    "10,\"unterminated,1,2026-01-01,01:02\n";
+
+            AttachmentPool loadPool("", database, "sysdba", "masterkey", "UTF8");
+            BulkLoader loader(loadPool);
+            loader.setTable("loaded");
+            BulkLoader::Options options;
+            options.parsers = 2;
+            options.chunkSize = 16;
+            loader.setOptions(options);
+            BulkLoader::Report report = loader.load(csv);
+            std::filesystem::remove(csv);
+
+            CHECK(report.rowsLoaded == 4 && report.rowsRejected == 6);
+            std::sort(report.rejected.begin(), report.rejected.end(),
+                    [](const BulkLoader::Rejected& a, const BulkLoader::Rejected& b) {
+                        return a.line < b.line;
+                    });
+            const std::pair<uint64_t, const char*> rejected[] = {{7, "invalid number"}, {8, "invalid number"},
+                {9, "invalid date"}, {10, "invalid time"}, {11, "wrong number of fields"}, {12, "unterminated quote"}};
+            CHECK(report.rejected.size() == 6);
+            for (size_t j = 0; j < 6 && j < report.rejected.size(); ++j)
+                CHECK(report.rejected[j].line == rejected[j].first && report.rejected[j].reason == rejected[j].second);
+            if (report.rejected.size() == 6)
+                CHECK(report.rejected[0].text == "5,bad,1.2.3,2026-01-01,01:02");
+
+            statement.setSql("SELECT NAME, AMOUNT, D, T FROM LOADED ORDER BY ID");
+            statement.open();
+            CHECK(statement.fetch() && statement.field(1).asDecimal() == Decimal(150, -2));
+            CHECK(statement.field(3).asIsoString() == "12:34:56.7890");
+            CHECK(statement.fetch() && statement.field(0).asString() == "with, comma");
+            CHECK(statement.field(1).asDecimal() == Decimal(-25, -2) && statement.field(2).formatDate() == "2000-02-29");
+            CHECK(statement.fetch() && statement.field(0).asString() == "say \"hi\"");
+            CHECK(statement.field(3).asIsoString() == "23:59:59.0000");
+            CHECK(statement.fetch() && statement.field(0).asString() == "two\nlines");
+            CHECK(statement.field(1).asDecimal() == Decimal(1, -2));
+            CHECK(!statement.fetch());
+            statement.close();
+
+            // quoted names keep their case
+            statement.setSql("CREATE TABLE \"Loaded \"\"Items\"\"\" (\"id\" INTEGER, \"Name\" VARCHAR(10))");
+            statement.execute();
+            transaction.commit();
+            std::ofstream(csv) << "id,Name\n1,one\n";
+            loader.setTable("\"Loaded \"\"Items\"\"\"");
+            report = loader.load(csv);
+            std::filesystem::remove(csv);
+            CHECK(report.rowsLoaded == 1 && report.rowsRejected == 0);
+        }
+
+        // retried transactions
+        {
+            Transaction locker;
+            locker.setAttachment(&attachment);
+            Statement lock;
+            lock.setTransaction(&locker);
+            lock.setSql("UPDATE TEST SET VAL = 0 WHERE ID = 1");
+            lock.execute();
+
+            Transaction retried;
+            retried.setAttachment(&attachment);
+            try {
+                retried.setOptions(Transaction::Options()
+                        .setIsolation(Transaction::Options::Isolation::READ_COMMITTED)
+                        .setAtSnapshotNumber(1));
+                CHECK(!"snapshot number without SNAPSHOT isolation");
+            } catch (const std::invalid_argument&) {
+            }
+            retried.setOptions(Transaction::Options()
+                    .setIsolation(Transaction::Options::Isolation::READ_COMMITTED)
+                    .setWait(false));
+            Statement update;
+            update.setTransaction(&retried);
+            update.setSql("UPDATE TEST SET VAL = 9.5 WHERE ID = 1");
+
+            // lock conflict under nowait, not retried with a single attempt
+            Transaction::RetryPolicy once;
+            once.maxAttempts = 1;
+            unsigned attempts = 0;
+            try {
+                retried.runInTransaction([&](Transaction&) {
+                    ++attempts;
+                    update.execute();
+                }, once);
+                CHECK(!"lock conflict expected");
+            } catch (const FbException& e) {
+                CHECK(Transaction::isConflict(e));
+            }
+            CHECK(attempts == 1 && !retried.isConnected());
+
+            // the second attempt finds the lock gone
+            Transaction::RetryPolicy policy;
+            policy.initialBackoff = std::chrono::milliseconds(1);
+            attempts = 0;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            retried.runInTransaction([&](Transaction&) {
+                if (++attempts == 2)
+                    locker.commit();
+                update.execute();
+            }, policy);
+            CHECK(attempts == 2 && !retried.isConnected());
+            CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(1));
+
+            // an active transaction is not taken over
+            retried.connect();
+            try {
+                retried.runInTransaction([](Transaction&) {
+                });
+                CHECK(!"logic_error expected");
+            } catch (const std::logic_error&) {
+            }
+            retried.rollback();
+
+            // read only: the error is not a conflict, no retry
+            retried.setOptions(Transaction::Options().setReadOnly());
+            attempts = 0;
+            try {
+                retried.runInTransaction([&](Transaction&) {
+                    ++attempts;
+                    update.execute();
+                }, policy);
+                CHECK(!"read only transaction updated");
+            } catch (const FbException& e) {
+                CHECK(!Transaction::isConflict(e));
+            }
+            CHECK(attempts == 1);
+
+            statement.setSql("SELECT VAL FROM TEST WHERE ID = 1");
+            statement.open();
+            CHECK(statement.fetch() && statement.field(0).asDouble() == 9.5);
+            statement.close();
+            transaction.commit();
+        }
+
+        // parallel scan
+        {
+            std::vector<ParallelScan::KeyRange> ranges = ParallelScan::splitKeys(1, 3, 4);
+            CHECK(ranges.size() == 3);
+            for (size_t j = 0; j < ranges.size(); ++j)
+                CHECK(ranges[j].low == int64_t(j + 1) && ranges[j].high == int64_t(j + 1));
+            ranges = ParallelScan::splitKeys(INT64_MIN, INT64_MAX, 4);
+            CHECK(ranges.size() == 4 && ranges[0].low == INT64_MIN && ranges[3].high == INT64_MAX);
+            for (size_t j = 1; j < ranges.size(); ++j) {
+                CHECK(ranges[j].low == ranges[j - 1].high + 1);
+                CHECK(ranges[j].high - ranges[j].low == ranges[0].high - ranges[0].low);
+            }
+
+            // a single connection pool scans the partitions one after the other
+            for (size_t maxSize : {1, 4}) {
+                AttachmentPool::Options options;
+                options.maxSize = maxSize;
+                AttachmentPool scanPool("", database, "sysdba", "masterkey", "UTF8", options);
+
+                for (ParallelScan::Partitioning partitioning : {ParallelScan::Partitioning::KEY_RANGE,
+                        ParallelScan::Partitioning::DB_KEY}) {
+                    ParallelScan scan(scanPool);
+                    scan.setTable("TEST");
+                    scan.setColumns("ID");
+                    scan.setPartitioning(partitioning, "ID");
+                    scan.setPartitions(4);
+                    std::atomic<unsigned> partitionRows[4] = {};
+                    scan.run([&](unsigned partition, Statement& s) {
+                        while (s.fetch())
+                            ++partitionRows[partition];
+                    });
+                    unsigned total = 0;
+                    for (const std::atomic<unsigned>& n : partitionRows) {
+                        CHECK(n > 0);
+                        total += n;
+                    }
+                    CHECK(total == 5);
+                }
+
+                // the ranges split the matching records only
+                ParallelScan filtered(scanPool);
+                filtered.setTable("TEST");
+                filtered.setColumns("ID");
+                filtered.setWhere("ID >= 3");
+                filtered.setPartitioning(ParallelScan::Partitioning::DB_KEY);
+                filtered.setPartitions(3);
+                std::atomic<unsigned> partitionRows[3] = {};
+                filtered.run([&](unsigned partition, Statement& s) {
+                    while (s.fetch())
+                        ++partitionRows[partition];
+                });
+                for (const std::atomic<unsigned>& n : partitionRows)
+                    CHECK(n == 1);
+            }
+        }
+
+        // error codes without exceptions
+        statement.setSql("INSERT INTO TEST (ID, DESC) VALUES (?, ?)");
+        CallResult result = statement.tryExecute(1, "DUP");
+        CHECK(!result && result.gdsCode() == isc_unique_key_violation);
+        CHECK(std::string(result.sqlState()) == "23000" && !result.isConflict());
+        result = statement.tryExecute(6, "FFF");
+        CHECK(result.ok() && std::string(result.sqlState()) == "00000");
+        statement.setSql("SELECT ID FROM TEST ORDER BY ID");
+        statement.open();
+        rows = 0;
+        while (statement.tryFetch(result))
+            ++rows;
+        CHECK(result.ok() && rows == 6);
+        statement.close();
+        CHECK(transaction.tryCommit().ok() && !transaction.isConnected());
+
+        // database events
+        {
+            std::mutex m;
+            std::condition_variable cv;
+            uint32_t posted = 0;
+            EventSubscription events(attachment);
+            events.setEvents({"TEST_EVENT", "OTHER_EVENT"});
+            events.setHandler([&](const std::vector<EventSubscription::Event>& list) {
+                std::lock_guard<std::mutex> lock(m);
+                for (const EventSubscription::Event& e : list) {
+                    CHECK(e.name == "TEST_EVENT");
+                    posted += e.count;
+                }
+                cv.notify_one();
+            });
+            events.start();
+
+            statement.setSql("EXECUTE BLOCK AS BEGIN POST_EVENT 'TEST_EVENT'; POST_EVENT 'TEST_EVENT'; END");
+            statement.execute();
+            transaction.commit();
+
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait_for(lock, std::chrono::seconds(10), [&] {
+                return posted >= 2;
+            });
+            CHECK(posted == 2);
+            lock.unlock();
+            events.stop();
+            CHECK(!events.isActive());
+        }
+
+        attachment.dropDatabase();
+    } catch (const FbException& e) {
+        char buf[256];
+        formatExceptionMessage(e, buf, 256);
+        std::cerr << buf << std::endl;
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    if (failures)
+        std::cerr << failures << " checks failed" << std::endl;
+
+    return failures ? 1 : 0;
+}
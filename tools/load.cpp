@@ -0,0 +1,76 @@
+/* 
+ * File:   load.cpp
+ * Created on 17 ottobre 2026
+ *
+ * Loads a CSV file into a table; rejected rows are written to stderr and the
+ * stage throughput to stdout. The user and password come from ISC_USER and
+ * ISC_PASSWORD, as for the Firebird tools.
+ * usage: load <server> <database> <table> <file> [parsers] [loaders]
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include "../BulkLoader.h"
+
+static void printStage(const char* name, const BulkLoader::Stage& stage) {
+    std::cout << "{\"stage\":\"" << name
+            << "\",\"rows\":" << stage.rows
+            << ",\"bytes\":" << stage.bytes
+            << ",\"seconds\":" << stage.wall.count() / 1e9
+            << ",\"busy_seconds\":" << stage.busy.count() / 1e9
+            << ",\"rows_per_sec\":" << stage.rowsPerSecond()
+            << ",\"mb_per_sec\":" << stage.megabytesPerSecond() << "}" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 5) {
+        std::cerr << "usage: " << argv[0] << " <server> <database> <table> <file> [parsers] [loaders]" << std::endl;
+        return 1;
+    }
+
+    const char* user = std::getenv("ISC_USER");
+    const char* password = std::getenv("ISC_PASSWORD");
+    if (!user) {
+        std::cerr << argv[0] << ": set ISC_USER and ISC_PASSWORD" << std::endl;
+        return 1;
+    }
+
+    BulkLoader::Options options;
+    if (argc > 5)
+        options.parsers = std::atoi(argv[5]);
+    if (argc > 6)
+        options.loaders = std::atoi(argv[6]);
+
+    try {
+        AttachmentPool::Options poolOptions;
+        poolOptions.maxSize = options.loaders + 1;
+        AttachmentPool pool(argv[1], argv[2], user, password ? password : "", "UTF8", poolOptions);
+
+        BulkLoader loader(pool);
+        loader.setTable(argv[3]);
+        loader.setOptions(options);
+        loader.setRejectHandler([](const BulkLoader::Rejected& r) {
+            std::cerr << "line " << r.line << ": " << r.reason << ": " << r.text << std::endl;
+        });
+
+        BulkLoader::Report report = loader.load(argv[4]);
+
+        printStage("split", report.split);
+        printStage("parse", report.parse);
+        printStage("load", report.load);
+        std::cout << "{\"rows_read\":" << report.rowsRead
+                << ",\"rows_loaded\":" << report.rowsLoaded
+                << ",\"rows_rejected\":" << report.rowsRejected
+                << ",\"seconds\":" << report.elapsed.count() / 1e9 << "}" << std::endl;
+    } catch (const FbException& e) {
+        char buf[256];
+        formatExceptionMessage(e, buf, 256);
+        std::cerr << buf << std::endl;
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}